@@ -86,38 +86,36 @@ void FlockingBehaviorExampleApp::update() {
 	entityx::ComponentHandle<sitara::ecs::Transform> transform;
 	entityx::ComponentHandle<sitara::ecs::LogicalLayer> layer;
 
+	ci::vec3 targetPosition = ci::vec3(sitara::ecs::Units::getInstance(10.0).getPixelsFromMeters(20.0) * std::cos(2.0 * M_PI * ci::app::getElapsedSeconds() / 8.0f),
+		sitara::ecs::Units::getInstance(10.0).getPixelsFromMeters(20.0) * std::sin(2.0 * M_PI * ci::app::getElapsedSeconds() / 8.0f),
+		0.0);
+
 	for (auto entity : mEntities.entities_with_components(target, layer, transform)) {
+		target->setTargetPosition(targetPosition);
 		if (layer->mLayerId == LayerNames::TARGET) {
-			target->setTargetPosition(ci::vec3(sitara::ecs::Units::getInstance(10.0).getPixelsFromMeters(20.0) * std::cos(2.0 * M_PI * ci::app::getElapsedSeconds() / 8.0f),
-				sitara::ecs::Units::getInstance(10.0).getPixelsFromMeters(20.0) * std::sin(2.0 * M_PI * ci::app::getElapsedSeconds() / 8.0f),
-												0.0));
 			transform->mPosition = target->getTargetPosition();
 		}
-		else if (layer->mLayerId == LayerNames::BOIDS) {
-			if (mBehaviorSelect == 0) {
-				mSystems.system<sitara::ecs::BehaviorSystem>()->seek(entity);
-			}
-			else if (mBehaviorSelect == 1) {
-				mSystems.system<sitara::ecs::BehaviorSystem>()->flee(entity);
-			}
-			else if (mBehaviorSelect == 2) {
-				mSystems.system<sitara::ecs::BehaviorSystem>()->arrive(entity);
-			}
-			else if (mBehaviorSelect == 3) {
-				mSystems.system<sitara::ecs::BehaviorSystem>()->wander(entity);
-			}
-			else if (mBehaviorSelect == 4) {
-				mSystems.system<sitara::ecs::BehaviorSystem>()->separate(entity, mEntities);
-				mSystems.system<sitara::ecs::BehaviorSystem>()->cohere(entity, mEntities);
-				mSystems.system<sitara::ecs::BehaviorSystem>()->align(entity, mEntities);
-			}
-
-			target->setTargetPosition(ci::vec3(sitara::ecs::Units::getInstance(10.0).getPixelsFromMeters(20.0) * std::cos(2.0 * M_PI * ci::app::getElapsedSeconds() / 8.0f),
-				sitara::ecs::Units::getInstance(10.0).getPixelsFromMeters(20.0) * std::sin(2.0 * M_PI * ci::app::getElapsedSeconds() / 8.0f),
-				0.0));
-		}
 	}
 
+	// the behavior system steers every boid in one batched pass
+	auto behaviors = mSystems.system<sitara::ecs::BehaviorSystem>();
+	if (mBehaviorSelect == 0) {
+		behaviors->setSteeringBehaviors(sitara::ecs::BehaviorSystem::SEEK);
+	}
+	else if (mBehaviorSelect == 1) {
+		behaviors->setSteeringBehaviors(sitara::ecs::BehaviorSystem::FLEE);
+	}
+	else if (mBehaviorSelect == 2) {
+		behaviors->setSteeringBehaviors(sitara::ecs::BehaviorSystem::ARRIVE);
+	}
+	else if (mBehaviorSelect == 3) {
+		behaviors->setSteeringBehaviors(sitara::ecs::BehaviorSystem::WANDER);
+	}
+	else if (mBehaviorSelect == 4) {
+		behaviors->setSteeringBehaviors(sitara::ecs::BehaviorSystem::FLOCK);
+	}
+
+	mSystems.update<sitara::ecs::BehaviorSystem>(1.0 / 60.0);
 	mSystems.update<sitara::ecs::PhysicsSystem>(1.0 / 60.0);
 	mSystems.update<sitara::ecs::TransformSystem>(1.0 / 60.0);
 }
@@ -11,11 +11,15 @@
 #include "transform/TransformSystem.h"
 
 #include "physics/Particle.h"
+#include "physics/Emitter.h"
 #include "physics/ParticleSystem.h"
 
 #include "physics/DynamicBody.h"
 #include "physics/StaticBody.h"
 #include "physics/OverlapDetector.h"
+#include "physics/PhysicsEvents.h"
+#include "physics/BodyTemplate.h"
+#include "physics/PhysicsScene.h"
 #include "physics/PhysicsSystem.h"
 #include "physics/PhysicsUtils.h"
 
@@ -50,13 +54,21 @@
 #include "utilities/FboSystem.h"
 #include "utilities/Tween.h"
 #include "utilities/TimelineSystem.h"
+#include "utilities/JobPool.h"
 
 namespace sitara {
 	namespace ecs {
-		inline void configureSystems(entityx::SystemManager& systems) {
+		/*
+		* numWorkers and pinThreads set up the JobPool shared by PhysX and the other systems; 0 workers means one per core
+		* (minus the main thread).  Call this before configuring any system so the pool is created with these settings.
+		*/
+		inline void configureSystems(entityx::SystemManager& systems, uint32_t numWorkers = 0, bool pinThreads = false) {
+			JobPool::configureInstance(numWorkers, pinThreads);
+
 			//systems.add<entityx::deps::Dependency<Target, Transform>>();
 			systems.add<entityx::deps::Dependency<Particle, Transform>>();
 			systems.add<entityx::deps::Dependency<Attractor, Transform>>();
+			systems.add<entityx::deps::Dependency<Emitter, Transform>>();
 			systems.add<entityx::deps::Dependency<DynamicBody, Transform>>();
 			systems.add<entityx::deps::Dependency<StaticBody, Transform>>();
 			systems.add<entityx::deps::Dependency<OverlapDetector, Transform>>();
@@ -1,13 +1,41 @@
 #pragma once
 
+#include <vector>
 #include "entityx/System.h"
 #include "cinder/Vector.h"
+#include "behavior/SpatialHash.h"
+#include "physics/DynamicBody.h"
+#include "utilities/JobPool.h"
 
 namespace sitara {
 	namespace ecs {
 		class BehaviorSystem : public entityx::System<BehaviorSystem> {
 		public:
+			/*
+			* Behaviors that update() evaluates for every body carrying the matching component.
+			* Defaults to NONE, in which case update() only refreshes Targets and apps are expected to call
+			* seek() / separate() / etc. per entity themselves; the neighbor index is then built on the first
+			* separate() / cohere() / align() call of each frame.
+			*/
+			enum Behavior : uint32_t {
+				NONE = 0,
+				SEEK = 1 << 0,
+				FLEE = 1 << 1,
+				ARRIVE = 1 << 2,
+				WANDER = 1 << 3,
+				SEPARATE = 1 << 4,
+				COHERE = 1 << 5,
+				ALIGN = 1 << 6,
+				FLOCK = SEPARATE | COHERE | ALIGN
+			};
+
+			BehaviorSystem();
 			void update(entityx::EntityManager &entities, entityx::EventManager &events, entityx::TimeDelta dt) override;
+			void setSteeringBehaviors(uint32_t behaviors);
+			uint32_t getSteeringBehaviors();
+			void setFleeDirection(const ci::vec3& nullDirection);
+			void setJobPool(JobPool* pool);
+			void enableMultithreading(const bool enable);
 			void seek(entityx::Entity& entity);
 			void flee(entityx::Entity& entity, ci::vec3 nullDirection = ci::vec3(0, 0, 1));
 			void arrive(entityx::Entity& entity);
@@ -15,7 +43,55 @@ namespace sitara {
 			void separate(entityx::Entity& entity, entityx::EntityManager& entities);
 			void cohere(entityx::Entity& entity, entityx::EntityManager& entities);
 			void align(entityx::Entity& entity, entityx::EntityManager& entities);
+			void buildNeighborIndex(entityx::EntityManager& entities);
 		private:
+			/*
+			* Behavior parameters copied out of each body's components when the snapshot is taken,
+			* so the batched pass never has to go back to the entity manager.
+			*/
+			struct SteeringAgent {
+				uint32_t mBehaviors;
+				ci::vec3 mTargetPosition;
+				float mTargetWeight;
+				float mSlowingDistance;
+				ci::vec4 mNoiseMultipliers;
+				ci::vec4 mNoiseOffsets;
+				float mNoiseWeight;
+				float mSeparationRadius;
+				float mSeparationWeight;
+				float mCohesionRadius;
+				float mCohesionWeight;
+				float mAlignmentRadius;
+				float mAlignmentWeight;
+			};
+
+			void refreshNeighborIndex(entityx::EntityManager& entities);
+			void computeSteeringForces(size_t begin, size_t end);
+			ci::vec3 separationForce(entityx::Entity::Id id, const ci::vec3& position, float zoneRadius, float weight) const;
+			ci::vec3 cohesionForce(entityx::Entity::Id id, const ci::vec3& position, const ci::vec3& velocity, float zoneRadius, float weight) const;
+			ci::vec3 alignmentForce(entityx::Entity::Id id, const ci::vec3& position, const ci::vec3& velocity, float zoneRadius, float weight) const;
+
+			uint32_t mSteeringBehaviors;
+			ci::vec3 mFleeDirection;
+			double mSteeringTime;
+			JobPool* mJobPool;
+			bool mMultithreaded;
+			static const size_t mSteeringGrainSize = 256;
+
+			/*
+			* Snapshot of the steered DynamicBodies (plus plain bodies while anything separates or aligns, since
+			* those count every body in their zone), taken at most once per frame and bucketed by the largest
+			* Separation / Cohesion / Alignment zone radius so neighbor searches only visit nearby cells.
+			*/
+			SpatialHash mNeighborIndex;
+			std::vector<ci::vec3> mPositions;
+			std::vector<ci::vec3> mVelocities;
+			std::vector<entityx::Entity::Id> mIds;
+			std::vector<SteeringAgent> mAgents;
+			std::vector<entityx::ComponentHandle<sitara::ecs::DynamicBody>> mBodies;
+			std::vector<ci::vec3> mForces;
+			uint32_t mNeighborIndexFrame;
+			bool mNeighborIndexBuilt;
 		};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include "cinder/Vector.h"
+
+namespace sitara {
+	namespace ecs {
+		/*
+		* Uniform grid over a set of points, hashed into a flat table so that we never allocate per cell.
+		* Rebuilding is a counting sort (two linear passes); the backing vectors keep their capacity between frames.
+		* Cells that land in the same bucket just share it, so query() hands back candidates -- callers still need to distance test.
+		*/
+		class SpatialHash {
+		public:
+			SpatialHash() : mCellSize(1.0f), mInverseCellSize(1.0f), mTableMask(0) {
+			}
+
+			void build(const std::vector<ci::vec3>& positions, float cellSize) {
+				mCellSize = (cellSize > 0.0f) ? cellSize : 1.0f;
+				mInverseCellSize = 1.0f / mCellSize;
+
+				size_t tableSize = 1;
+				while (tableSize < 2 * positions.size()) {
+					tableSize <<= 1;
+				}
+				mTableMask = static_cast<uint32_t>(tableSize - 1);
+
+				mBucketStart.assign(tableSize + 1, 0);
+				mPointBuckets.resize(positions.size());
+				mEntries.resize(positions.size());
+
+				for (size_t i = 0; i < positions.size(); i++) {
+					const ci::vec3& p = positions[i];
+					uint32_t bucket = hash(cellCoordinate(p.x), cellCoordinate(p.y), cellCoordinate(p.z));
+					mPointBuckets[i] = bucket;
+					mBucketStart[bucket + 1]++;
+				}
+
+				for (size_t b = 0; b < tableSize; b++) {
+					mBucketStart[b + 1] += mBucketStart[b];
+				}
+
+				mBucketCursor.assign(mBucketStart.begin(), mBucketStart.end() - 1);
+				for (size_t i = 0; i < positions.size(); i++) {
+					mEntries[mBucketCursor[mPointBuckets[i]]++] = static_cast<uint32_t>(i);
+				}
+			}
+
+			void clear() {
+				mBucketStart.clear();
+				mEntries.clear();
+			}
+
+			bool empty() const {
+				return mEntries.empty();
+			}
+
+			float getCellSize() const {
+				return mCellSize;
+			}
+
+			/*
+			* Calls fn(index) for every point whose cell overlaps the box [center - radius, center + radius].
+			* Each point is visited at most once.  Safe to call from multiple threads once build() has returned.
+			*/
+			template <typename Fn>
+			void query(const ci::vec3& center, float radius, Fn&& fn) const {
+				if (mEntries.empty()) {
+					return;
+				}
+
+				int minX = cellCoordinate(center.x - radius);
+				int minY = cellCoordinate(center.y - radius);
+				int minZ = cellCoordinate(center.z - radius);
+				int maxX = cellCoordinate(center.x + radius);
+				int maxY = cellCoordinate(center.y + radius);
+				int maxZ = cellCoordinate(center.z + radius);
+
+				int64_t cellCount = int64_t(maxX - minX + 1) * int64_t(maxY - minY + 1) * int64_t(maxZ - minZ + 1);
+				if (cellCount > mMaxQueryCells) {
+					// radius is much larger than the grid spacing; scanning everything is cheaper than hashing every cell
+					for (uint32_t index : mEntries) {
+						fn(index);
+					}
+					return;
+				}
+
+				uint32_t visited[mMaxQueryCells];
+				int visitedCount = 0;
+
+				for (int x = minX; x <= maxX; x++) {
+					for (int y = minY; y <= maxY; y++) {
+						for (int z = minZ; z <= maxZ; z++) {
+							uint32_t bucket = hash(x, y, z);
+
+							bool seen = false;
+							for (int i = 0; i < visitedCount; i++) {
+								if (visited[i] == bucket) {
+									seen = true;
+									break;
+								}
+							}
+							if (seen) {
+								continue;
+							}
+							visited[visitedCount++] = bucket;
+
+							for (uint32_t e = mBucketStart[bucket]; e < mBucketStart[bucket + 1]; e++) {
+								fn(mEntries[e]);
+							}
+						}
+					}
+				}
+			}
+
+		private:
+			int cellCoordinate(float value) const {
+				return static_cast<int>(std::floor(value * mInverseCellSize));
+			}
+
+			uint32_t hash(int x, int y, int z) const {
+				return ((uint32_t(x) * 73856093u) ^ (uint32_t(y) * 19349663u) ^ (uint32_t(z) * 83492791u)) & mTableMask;
+			}
+
+			static const int mMaxQueryCells = 64;
+
+			float mCellSize;
+			float mInverseCellSize;
+			uint32_t mTableMask;
+			std::vector<uint32_t> mBucketStart;
+			std::vector<uint32_t> mBucketCursor;
+			std::vector<uint32_t> mPointBuckets;
+			std::vector<uint32_t> mEntries;
+		};
+	}
+}
@@ -42,6 +42,10 @@ namespace sitara {
 				mForceStrength = strength;
 			}
 
+			ci::vec3 getStrength() {
+				return mForceStrength;
+			}
+
 			void turnOn() {
 				mIsOn = true;
 			}
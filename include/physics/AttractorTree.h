@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "cinder/Vector.h"
+
+namespace sitara {
+	namespace ecs {
+		/*
+		* Barnes-Hut octree over a set of point attractors.
+		*
+		* An attractor pulls a particle of mass m at p with  m * s_k * (a_k - p_k) / |a - p|^2  on each axis k.
+		* For a cluster that is far away we replace every |a - p| with the distance to the cluster's centroid, so the
+		* whole cluster collapses to  m * (W_k - p_k * S_k) / |c - p|^2  where S_k = sum(s_k) and W_k = sum(s_k * a_k).
+		* Only the distance is approximated; the numerator is exact.
+		*
+		* A node is treated as a single cluster when (edge length / distance) < theta.  theta = 0 is exact, ~0.5 is the
+		* usual trade-off, and larger values get faster and less accurate.
+		*/
+		class AttractorTree {
+		public:
+			AttractorTree() : mTheta(0.5f) {
+			}
+
+			void setTheta(float theta) {
+				mTheta = std::max(theta, 0.0f);
+			}
+
+			float getTheta() const {
+				return mTheta;
+			}
+
+			void build(const std::vector<ci::vec3>& positions, const std::vector<ci::vec3>& strengths) {
+				mNodes.clear();
+				mPositions.clear();
+				mStrengths.clear();
+				mOrder.resize(positions.size());
+				for (uint32_t i = 0; i < mOrder.size(); i++) {
+					mOrder[i] = i;
+				}
+
+				if (positions.empty()) {
+					return;
+				}
+
+				ci::vec3 minimum = positions[0];
+				ci::vec3 maximum = positions[0];
+				for (const ci::vec3& p : positions) {
+					minimum = glm::min(minimum, p);
+					maximum = glm::max(maximum, p);
+				}
+				ci::vec3 extent = maximum - minimum;
+				float halfSize = 0.5f * std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-3f));
+
+				mScratch.resize(positions.size());
+				mNodes.resize(1);
+				buildNode(positions, strengths, 0, 0, static_cast<uint32_t>(positions.size()), 0.5f * (minimum + maximum), halfSize, 0);
+
+				// store attractors in leaf order so leaves read a contiguous range
+				mPositions.reserve(positions.size());
+				mStrengths.reserve(strengths.size());
+				for (uint32_t index : mOrder) {
+					mPositions.push_back(positions[index]);
+					mStrengths.push_back(strengths[index]);
+				}
+			}
+
+			ci::vec3 evaluate(const ci::vec3& position, float mass) const {
+				ci::vec3 force(0);
+				if (mNodes.empty()) {
+					return force;
+				}
+
+				// depth-first, so at most 7 pending siblings per level plus the 8 children just pushed
+				uint32_t stack[mMaxDepth * 7 + 8];
+				int stackSize = 0;
+				stack[stackSize++] = 0;
+
+				while (stackSize > 0) {
+					const Node& node = mNodes[stack[--stackSize]];
+
+					if (node.mFirstChild == 0) {
+						for (uint32_t i = node.mBegin; i < node.mEnd; i++) {
+							ci::vec3 offset = mPositions[i] - position;
+							float distanceSq = glm::dot(offset, offset);
+							force += (mass / distanceSq) * offset * mStrengths[i];
+						}
+						continue;
+					}
+
+					ci::vec3 offset = node.mCentroid - position;
+					float distanceSq = glm::dot(offset, offset);
+					float size = 2.0f * node.mHalfSize;
+					if (size * size < mTheta * mTheta * distanceSq) {
+						force += (mass / distanceSq) * (node.mWeightedPosition - position * node.mStrength);
+						continue;
+					}
+
+					for (uint32_t c = 0; c < node.mChildCount; c++) {
+						stack[stackSize++] = node.mFirstChild + c;
+					}
+				}
+
+				return force;
+			}
+
+		private:
+			struct Node {
+				ci::vec3 mCentroid;
+				ci::vec3 mStrength;			// S_k
+				ci::vec3 mWeightedPosition;	// W_k
+				float mHalfSize;
+				uint32_t mFirstChild;		// 0 for leaves; the root can never be a child
+				uint32_t mChildCount;
+				uint32_t mBegin;
+				uint32_t mEnd;
+			};
+
+			void buildNode(const std::vector<ci::vec3>& positions, const std::vector<ci::vec3>& strengths, uint32_t nodeIndex,
+						   uint32_t begin, uint32_t end, const ci::vec3& center, float halfSize, int depth) {
+				Node node;
+				node.mCentroid = ci::vec3(0);
+				node.mStrength = ci::vec3(0);
+				node.mWeightedPosition = ci::vec3(0);
+				node.mHalfSize = halfSize;
+				node.mFirstChild = 0;
+				node.mChildCount = 0;
+				node.mBegin = begin;
+				node.mEnd = end;
+
+				for (uint32_t i = begin; i < end; i++) {
+					const ci::vec3& p = positions[mOrder[i]];
+					const ci::vec3& s = strengths[mOrder[i]];
+					node.mCentroid += p;
+					node.mStrength += s;
+					node.mWeightedPosition += s * p;
+				}
+				node.mCentroid /= float(end - begin);
+
+				if (end - begin > mLeafSize && depth < mMaxDepth) {
+					// counting sort this node's range by octant
+					uint32_t starts[9] = { begin };
+					for (uint32_t i = begin; i < end; i++) {
+						starts[octant(positions[mOrder[i]], center) + 1]++;
+					}
+					uint32_t childCount = 0;
+					for (int o = 0; o < 8; o++) {
+						if (starts[o + 1] > 0) {
+							childCount++;
+						}
+						starts[o + 1] += starts[o];
+					}
+
+					uint32_t cursor[8];
+					std::copy(starts, starts + 8, cursor);
+					for (uint32_t i = begin; i < end; i++) {
+						mScratch[cursor[octant(positions[mOrder[i]], center)]++] = mOrder[i];
+					}
+					std::copy(mScratch.begin() + begin, mScratch.begin() + end, mOrder.begin() + begin);
+
+					// siblings are allocated together so a node only needs the first child's index
+					node.mFirstChild = static_cast<uint32_t>(mNodes.size());
+					node.mChildCount = childCount;
+					mNodes.resize(mNodes.size() + childCount);
+
+					float childHalf = 0.5f * halfSize;
+					uint32_t child = node.mFirstChild;
+					for (int o = 0; o < 8; o++) {
+						if (starts[o] == starts[o + 1]) {
+							continue;
+						}
+						ci::vec3 childCenter = center + childHalf * ci::vec3((o & 1) ? 1.0f : -1.0f, (o & 2) ? 1.0f : -1.0f, (o & 4) ? 1.0f : -1.0f);
+						buildNode(positions, strengths, child++, starts[o], starts[o + 1], childCenter, childHalf, depth + 1);
+					}
+				}
+
+				mNodes[nodeIndex] = node;
+			}
+
+			static int octant(const ci::vec3& p, const ci::vec3& center) {
+				return (p.x >= center.x ? 1 : 0) | (p.y >= center.y ? 2 : 0) | (p.z >= center.z ? 4 : 0);
+			}
+
+			static const uint32_t mLeafSize = 4;
+			static const int mMaxDepth = 16;
+
+			float mTheta;
+			std::vector<Node> mNodes;
+			std::vector<uint32_t> mOrder;
+			std::vector<uint32_t> mScratch;
+			std::vector<ci::vec3> mPositions;
+			std::vector<ci::vec3> mStrengths;
+		};
+	}
+}
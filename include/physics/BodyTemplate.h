@@ -0,0 +1,94 @@
+#pragma once
+
+#include "PxPhysicsAPI.h"
+#include "cinder/Vector.h"
+#include "physics/PhysicsUtils.h"
+
+namespace sitara {
+	namespace ecs {
+		/*
+		* Describes one kind of body for PhysicsSystem::createDynamicBodies()/createStaticBodies(): shape, material and
+		* mass.  Set mSharedShape to have every body reuse one PxShape instead of getting its own copy.
+		*/
+		struct BodyTemplate {
+			enum Shape { SPHERE, CAPSULE, BOX, CONVEX_MESH };
+
+			static BodyTemplate sphere(float radius, physx::PxMaterial* material, float mass = 1.0f) {
+				BodyTemplate bodyTemplate(SPHERE, material, mass);
+				bodyTemplate.mDimensions = ci::vec3(radius);
+				return bodyTemplate;
+			}
+
+			static BodyTemplate capsule(float radius, float halfHeight, physx::PxMaterial* material, float mass = 1.0f) {
+				BodyTemplate bodyTemplate(CAPSULE, material, mass);
+				bodyTemplate.mDimensions = ci::vec3(radius, halfHeight, radius);
+				return bodyTemplate;
+			}
+
+			static BodyTemplate box(const ci::vec3& halfEdges, physx::PxMaterial* material, float mass = 1.0f) {
+				BodyTemplate bodyTemplate(BOX, material, mass);
+				bodyTemplate.mDimensions = halfEdges;
+				return bodyTemplate;
+			}
+
+			static BodyTemplate convexMesh(physx::PxConvexMesh* mesh, physx::PxMaterial* material, float mass = 1.0f, const ci::vec3& scale = ci::vec3(1.0f)) {
+				BodyTemplate bodyTemplate(CONVEX_MESH, material, mass);
+				bodyTemplate.mConvexMesh = mesh;
+				bodyTemplate.mDimensions = scale;
+				return bodyTemplate;
+			}
+
+			BodyTemplate(Shape shape = SPHERE, physx::PxMaterial* material = nullptr, float mass = 1.0f) {
+				mShape = shape;
+				mDimensions = ci::vec3(1.0f);
+				mConvexMesh = nullptr;
+				mMaterial = material;
+				mSharedShape = nullptr;
+				mMass = mass;
+				mLinearDamping = 0.0f;
+				mAngularDamping = 0.05f;
+			}
+
+			bool operator==(const BodyTemplate& other) const {
+				return mShape == other.mShape && mDimensions == other.mDimensions && mConvexMesh == other.mConvexMesh &&
+					mMaterial == other.mMaterial && mSharedShape == other.mSharedShape && mMass == other.mMass &&
+					mLinearDamping == other.mLinearDamping && mAngularDamping == other.mAngularDamping;
+			}
+
+			// attaches the template's shape to actor, matching DynamicBody::attachSphere() etc.
+			physx::PxShape* attachTo(physx::PxRigidActor& actor) const {
+				if (mSharedShape) {
+					actor.attachShape(*mSharedShape);
+					return mSharedShape;
+				}
+
+				physx::PxShape* shape = nullptr;
+				switch (mShape) {
+				case SPHERE:
+					shape = physx::PxRigidActorExt::createExclusiveShape(actor, physx::PxSphereGeometry(mDimensions.x), *mMaterial);
+					break;
+				case CAPSULE:
+					shape = physx::PxRigidActorExt::createExclusiveShape(actor, physx::PxCapsuleGeometry(mDimensions.x, mDimensions.y), *mMaterial);
+					shape->setLocalPose(physx::PxTransform(physx::PxQuat(physx::PxHalfPi, physx::PxVec3(0, 0, 1))));
+					break;
+				case BOX:
+					shape = physx::PxRigidActorExt::createExclusiveShape(actor, physx::PxBoxGeometry(sitara::ecs::physics::to(mDimensions)), *mMaterial);
+					break;
+				case CONVEX_MESH:
+					shape = physx::PxRigidActorExt::createExclusiveShape(actor, physx::PxConvexMeshGeometry(mConvexMesh, physx::PxMeshScale(sitara::ecs::physics::to(mDimensions))), *mMaterial);
+					break;
+				}
+				return shape;
+			}
+
+			Shape mShape;
+			ci::vec3 mDimensions;	// radius in x; capsule half height in y; box half edges; mesh scale
+			physx::PxConvexMesh* mConvexMesh;
+			physx::PxMaterial* mMaterial;
+			physx::PxShape* mSharedShape;
+			float mMass;
+			float mLinearDamping;
+			float mAngularDamping;
+		};
+	}
+}
@@ -4,6 +4,7 @@
 #include "entityx/Entity.h"
 #include "cinder/Vector.h"
 #include "physics/PhysicsUtils.h"
+#include "physics/PhysicsEvents.h"
 
 namespace sitara {
 	namespace ecs {
@@ -12,11 +13,17 @@ namespace sitara {
 			DynamicBody() {
 				mBody = nullptr;
 				mShape = nullptr;
+				mPreviousPose = physx::PxTransform(physx::PxIdentity);
+				mPoolIndex = -1;
+				mKinematic = false;
 			}
 
 			DynamicBody(physx::PxRigidDynamic* DynamicBody) {
 				mBody = DynamicBody;
 				mShape = nullptr;
+				mPreviousPose = mBody->getGlobalPose();
+				mPoolIndex = -1;
+				mKinematic = mBody->getRigidBodyFlags().isSet(physx::PxRigidBodyFlag::eKINEMATIC);
 			}
 
 			~DynamicBody() {
@@ -64,6 +71,47 @@ namespace sitara {
 				mShape = physx::PxRigidActorExt::createExclusiveShape(*mBody, physx::PxBoxGeometry(halfEdges.x, halfEdges.y, halfEdges.z), *material);
 			}
 
+			// mesh from PhysicsSystem::cookConvexMesh()
+			void attachConvexMesh(physx::PxConvexMesh* mesh, physx::PxMaterial* material, const ci::vec3& scale = ci::vec3(1.0f)) {
+				mShape = physx::PxRigidActorExt::createExclusiveShape(*mBody, physx::PxConvexMeshGeometry(mesh, physx::PxMeshScale(sitara::ecs::physics::to(scale))), *material);
+			}
+
+			/*
+			* Turns the attached shape into a trigger: it stops colliding and PhysicsSystem emits TriggerEvents when
+			* other bodies enter or leave it.  Call after attaching a shape.
+			*/
+			void setTrigger(bool trigger) {
+				if (mShape) {
+					// a shape can't be a simulation shape and a trigger at the same time, so clear one before setting the other
+					if (trigger) {
+						mShape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, false);
+						mShape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, true);
+					}
+					else {
+						mShape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, false);
+						mShape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, true);
+					}
+				}
+			}
+
+			bool isTrigger() {
+				return mShape && mShape->getFlags().isSet(physx::PxShapeFlag::eTRIGGER_SHAPE);
+			}
+
+			// emit ContactEvents whenever the attached shape starts or stops touching another
+			void enableContactReports(bool enable) {
+				if (mShape) {
+					physx::PxFilterData filterData = mShape->getSimulationFilterData();
+					if (enable) {
+						filterData.word2 |= sitara::ecs::physics::REPORT_CONTACTS;
+					}
+					else {
+						filterData.word2 &= ~physx::PxU32(sitara::ecs::physics::REPORT_CONTACTS);
+					}
+					mShape->setSimulationFilterData(filterData);
+				}
+			}
+
 			const ci::vec3 getPosition() {
 				return sitara::ecs::physics::from(mBody->getGlobalPose().p);
 			}
@@ -72,6 +120,18 @@ namespace sitara {
 				return sitara::ecs::physics::from(mBody->getGlobalPose().q);
 			}
 
+			/*
+			* Pose between the last two fixed steps; alpha = 0 is the previous step and 1 the latest.
+			* Only meaningful when PhysicsSystem runs with a fixed time step.
+			*/
+			const ci::vec3 getInterpolatedPosition(float alpha) {
+				return glm::mix(sitara::ecs::physics::from(mPreviousPose.p), getPosition(), alpha);
+			}
+
+			const ci::quat getInterpolatedRotation(float alpha) {
+				return glm::slerp(sitara::ecs::physics::from(mPreviousPose.q), getRotation(), alpha);
+			}
+
 			const ci::vec3 getVelocity() {
 				return sitara::ecs::physics::from(mBody->getLinearVelocity());
 			}
@@ -97,12 +157,25 @@ namespace sitara {
 				mBody->clearTorque();
 			}
 
+			// cached, so it doesn't touch the actor; switch with PhysicsSystem::setKinematic()
+			bool isKinematic() {
+				return mKinematic;
+			}
+
 			void resetBody(const ci::vec3& position, const ci::vec3& velocity = ci::vec3(), const ci::quat& rotation = ci::quat(), const ci::vec3& angularVelocity = ci::vec3()) {
 				physx::PxTransform nullTransform = sitara::ecs::physics::to(rotation, position);
 
+				if (isKinematic()) {
+					// velocities and forces don't apply to kinematic bodies
+					mBody->setGlobalPose(nullTransform);
+					mPreviousPose = nullTransform;
+					return;
+				}
+
 				mBody->setLinearVelocity(sitara::ecs::physics::to(velocity));
 				mBody->setAngularVelocity(sitara::ecs::physics::to(angularVelocity));
 				mBody->setGlobalPose(nullTransform, true);
+				mPreviousPose = nullTransform;
 				mBody->clearForce();
 				mBody->clearTorque();
 			}
@@ -120,12 +193,24 @@ namespace sitara {
 				return mBody;
 			}
 
+			void setKinematic(bool kinematic) {
+				mBody->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, kinematic);
+				mKinematic = kinematic;
+			}
+
 			void setVelocity(const ci::vec3& velocity) {
 				mBody->setLinearVelocity(sitara::ecs::physics::to(velocity));
 			}
 
+			void savePreviousPose() {
+				mPreviousPose = mBody->getGlobalPose();
+			}
+
 			physx::PxRigidDynamic* mBody;
 			physx::PxShape* mShape;
+			physx::PxTransform mPreviousPose;
+			int mPoolIndex;		// PhysicsSystem body pool the actor goes back to, or -1 to release it
+			bool mKinematic;
 
 			friend class PhysicsSystem;
 		};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "Particle.h"
+#include "entityx/Entity.h"
+#include "cinder/Vector.h"
+
+namespace sitara {
+	namespace ecs {
+		/*
+		* Spawns particles from a fixed-size pool owned by the ParticleSystem.  The pool's entities are created once, the
+		* first time the system sees the emitter; after that spawning reuses dead slots and expired particles are
+		* retired in place, so steady fountains and bursts never create or destroy entities.
+		*/
+		class Emitter {
+		public:
+			Emitter(size_t capacity, float rate = 0.0f, float lifetime = 1.0f, float mass = 1.0f) {
+				mCapacity = capacity;
+				mRate = rate;
+				mLifetime = lifetime;
+				mMass = mass;
+				mVelocity = ci::vec3(0);
+				mVelocitySpread = 0.0f;
+				mPendingBurst = 0;
+				mSpawnAccumulator = 0.0f;
+				mIsOn = true;
+				mCreateFn = nullptr;
+			}
+
+			// particles per second while the emitter is on
+			void setRate(float rate) {
+				mRate = rate;
+			}
+
+			float getRate() {
+				return mRate;
+			}
+
+			// spawns count particles on the next update, on top of the regular rate
+			void burst(size_t count) {
+				mPendingBurst += count;
+			}
+
+			void setLifetime(float seconds) {
+				mLifetime = seconds;
+			}
+
+			float getLifetime() {
+				return mLifetime;
+			}
+
+			void setMass(float mass) {
+				mMass = mass;
+			}
+
+			// new particles start at velocity plus a random offset of length spread
+			void setVelocity(const ci::vec3& velocity, float spread = 0.0f) {
+				mVelocity = velocity;
+				mVelocitySpread = spread;
+			}
+
+			/*
+			* Called once for every pooled entity when the pool is built, e.g. to attach a Geometry.
+			* Don't destroy the entity or remove its Particle from here.
+			*/
+			void setCreateFn(std::function<void(entityx::Entity)> fn) {
+				mCreateFn = fn;
+			}
+
+			void turnOn() {
+				mIsOn = true;
+			}
+
+			void turnOff() {
+				mIsOn = false;
+			}
+
+			bool isOn() {
+				return mIsOn;
+			}
+
+			size_t getCapacity() {
+				return mCapacity;
+			}
+
+			size_t getLiveCount() {
+				return mPool.size() - mFreeSlots.size();
+			}
+
+		protected:
+			size_t mCapacity;
+			float mRate;
+			float mLifetime;
+			float mMass;
+			ci::vec3 mVelocity;
+			float mVelocitySpread;
+			size_t mPendingBurst;
+			float mSpawnAccumulator;
+			bool mIsOn;
+			std::function<void(entityx::Entity)> mCreateFn;
+
+			std::vector<entityx::Entity> mPool;
+			std::vector<entityx::ComponentHandle<Particle>> mPoolParticles;
+			std::vector<bool> mSlotInUse;
+			std::vector<uint32_t> mFreeSlots;
+
+			friend class ParticleSystem;
+		};
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "PxPhysicsAPI.h"
+#include "utilities/JobPool.h"
+
+namespace sitara {
+	namespace ecs {
+		/*
+		* Runs PhysX's simulation tasks on a JobPool, so the physics step and our own parallel passes share one set of
+		* threads instead of each spinning up a pool sized to the whole machine.
+		*/
+		class JobPoolDispatcher : public physx::PxCpuDispatcher {
+		public:
+			JobPoolDispatcher(JobPool& pool) : mPool(pool) {
+			}
+
+			void submitTask(physx::PxBaseTask& task) override {
+				// same contract as PxDefaultCpuDispatcher: run, then release so PhysX can chain the continuation
+				physx::PxBaseTask* submitted = &task;
+				mPool.submit([submitted]() {
+					submitted->run();
+					submitted->release();
+				});
+			}
+
+			uint32_t getWorkerCount() const override {
+				return mPool.getWorkerCount();
+			}
+
+		private:
+			JobPool& mPool;
+		};
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include "PxPhysicsAPI.h"
 #include "entityx/Entity.h"
 #include "cinder/Vector.h"
@@ -9,31 +10,31 @@ namespace sitara {
 	namespace ecs {
 		class OverlapDetector {
 		public:
-			OverlapDetector(const ci::vec3& center, float overlapDistance) : mCurrentResults(NULL),
-				mPreviousResults(NULL),
-				mQueryFilter(),
+			OverlapDetector(const ci::vec3& center, float overlapDistance) : mQueryFilter(),
 				mTransform(sitara::ecs::physics::to(ci::quat(), center)) {
 				mOverlapShape = new physx::PxSphereGeometry(overlapDistance);
-				mCurrentResults.reserve(4096);
-				mPreviousResults.reserve(4096);
+				mHitCapacity = mInitialHitCapacity;
+				mIncludeLayers = ~0u;
+				mExcludeLayers = 0;
+				mNeedsQuery = true;
 			}
 
-			OverlapDetector(const ci::vec3& center, ci::vec2 overlapDimensions) : mCurrentResults(NULL),
-				mPreviousResults(NULL),
-				mQueryFilter(),
+			OverlapDetector(const ci::vec3& center, ci::vec2 overlapDimensions) : mQueryFilter(),
 				mTransform(sitara::ecs::physics::to(ci::quat(), center)) {
 				mOverlapShape = new physx::PxCapsuleGeometry(overlapDimensions.x, overlapDimensions.y);
-				mCurrentResults.reserve(4096);
-				mPreviousResults.reserve(4096);
+				mHitCapacity = mInitialHitCapacity;
+				mIncludeLayers = ~0u;
+				mExcludeLayers = 0;
+				mNeedsQuery = true;
 			}
 
-			OverlapDetector(const ci::vec3& center, ci::vec3 overlapDimensions) : mCurrentResults(NULL),
-				mPreviousResults(NULL),
-				mQueryFilter(),
+			OverlapDetector(const ci::vec3& center, ci::vec3 overlapDimensions) : mQueryFilter(),
 				mTransform(sitara::ecs::physics::to(ci::quat(), center)) {
 				mOverlapShape = new physx::PxBoxGeometry(sitara::ecs::physics::to(overlapDimensions));
-				mCurrentResults.reserve(4096);
-				mPreviousResults.reserve(4096);
+				mHitCapacity = mInitialHitCapacity;
+				mIncludeLayers = ~0u;
+				mExcludeLayers = 0;
+				mNeedsQuery = true;
 			}
 
 			~OverlapDetector() {
@@ -43,14 +44,47 @@ namespace sitara {
 			void queryAll() {
 				mQueryFilter.flags = physx::PxQueryFlag::eSTATIC;
 				mQueryFilter.flags |= physx::PxQueryFlag::eDYNAMIC;
+				mNeedsQuery = true;
 			}
 
 			void queryStaticOnly() {
 				mQueryFilter.flags = physx::PxQueryFlag::eSTATIC;
+				mNeedsQuery = true;
 			}
 
 			void queryDynamicOnly() {
 				mQueryFilter.flags = physx::PxQueryFlag::eDYNAMIC;
+				mNeedsQuery = true;
+			}
+
+			/*
+			* Restricts hits to bodies whose LogicalLayer is in includeLayers and not in excludeLayers (bit n is layer n).
+			* Filtering happens inside the PhysX query, so other bodies never reach the hit buffer or the callbacks.
+			* With a mask set, bodies without a LogicalLayer aren't reported either.  clearLayerMask() goes back to
+			* reporting everything.
+			*/
+			void setLayerMask(uint32_t includeLayers, uint32_t excludeLayers = 0) {
+				mIncludeLayers = includeLayers;
+				mExcludeLayers = excludeLayers;
+				updateLayerFilter();
+			}
+
+			void includeLayer(int layerId) {
+				if (layerId >= 0 && layerId < 32) {
+					mIncludeLayers = (mIncludeLayers == ~0u ? 0u : mIncludeLayers) | (1u << layerId);
+					updateLayerFilter();
+				}
+			}
+
+			void excludeLayer(int layerId) {
+				if (layerId >= 0 && layerId < 32) {
+					mExcludeLayers |= (1u << layerId);
+					updateLayerFilter();
+				}
+			}
+
+			void clearLayerMask() {
+				setLayerMask(~0u, 0);
 			}
 
 			void addOnEnterEachOverlapFn(std::function<void(entityx::Entity thisEntity, entityx::Entity overlappingEntity)> callback) {
@@ -78,41 +112,72 @@ namespace sitara {
 				return mTransform;
 			}
 
-			physx::PxOverlapHit* getWriteBuffer() {
-				return mCurrentResults.data();
-			}
-
-			int getBufferSize() {
-				return mBufferSize;
+			/*
+			* Keeps the ids of the overlapping entities, sorted and without duplicates (an actor with several shapes
+			* reports one hit per shape), so PhysicsSystem can diff two frames with a single merge pass.
+			*/
+			void setResults(const physx::PxOverlapHit* hits, size_t count) {
+				mCurrentOverlaps.clear();
+				for (size_t i = 0; i < count; i++) {
+					if (hits[i].actor != nullptr) {
+						mCurrentOverlaps.push_back(entityx::Entity::Id((uint64_t)(hits[i].actor->userData)));
+					}
+				}
+				std::sort(mCurrentOverlaps.begin(), mCurrentOverlaps.end());
+				mCurrentOverlaps.erase(std::unique(mCurrentOverlaps.begin(), mCurrentOverlaps.end()), mCurrentOverlaps.end());
 			}
 
-			void resizeBuffer(size_t size) {
-				mCurrentResults.resize(size);
+			// keeps last frame's overlaps when PhysicsSystem skips the query (see enableIncrementalOverlaps())
+			void reuseResults() {
+				mCurrentOverlaps = mPreviousOverlaps;
 			}
 
 			void saveResults() {
-				mPreviousResults = mCurrentResults;
+				mPreviousOverlaps.swap(mCurrentOverlaps);
 			}
 
-			std::vector<physx::PxOverlapHit>& getResults() {
-				return mCurrentResults;
+			const std::vector<entityx::Entity::Id>& getResults() {
+				return mCurrentOverlaps;
 			}
 
-			std::vector<physx::PxOverlapHit>& getPreviousResults() {
-				return mPreviousResults;
+			const std::vector<entityx::Entity::Id>& getPreviousResults() {
+				return mPreviousOverlaps;
 			}
 
 			physx::PxQueryFilterData& getFilter() {
 				return mQueryFilter;
 			}
 
-			static const int mBufferSize = 4096;
+			void updateLayerFilter() {
+				// PhysX skips a shape when (query data & shape query data) is zero across all four words
+				mQueryFilter.data = physx::PxFilterData();
+				mNeedsQuery = true;
+				if (mIncludeLayers != ~0u || mExcludeLayers != 0) {
+					mQueryFilter.data.word0 = mIncludeLayers & ~mExcludeLayers;
+					if (mQueryFilter.data.word0 == 0) {
+						// all-zero data means "no filtering"; a bit no shape sets in word1 rejects everything instead
+						mQueryFilter.data.word1 = 1;
+					}
+				}
+			}
+
+			/*
+			* Hits this detector may write into PhysicsSystem's shared arena per query.  Starts small and doubles whenever
+			* a query fills it, so memory follows what the zone actually sees instead of a fixed 4096 per detector.
+			*/
+			static const uint32_t mInitialHitCapacity = 16;
+			static const uint32_t mMaxHitCapacity = 4096;
+			uint32_t mHitCapacity;
 			physx::PxGeometry* mOverlapShape;
 			physx::PxTransform mTransform;
 			physx::PxQueryFilterData mQueryFilter;
+			uint32_t mIncludeLayers;
+			uint32_t mExcludeLayers;
+			bool mNeedsQuery;					// the query itself changed since the last run
+			physx::PxTransform mQueryPose;		// pose of the last query that actually ran
 			
-			std::vector<physx::PxOverlapHit> mCurrentResults;
-			std::vector<physx::PxOverlapHit> mPreviousResults;
+			std::vector<entityx::Entity::Id> mCurrentOverlaps;
+			std::vector<entityx::Entity::Id> mPreviousOverlaps;
 
 			std::vector<std::function<void(entityx::Entity thisEntity, entityx::Entity overlappingEntity)> > mOnEnterEachOverlapFns;
 			std::vector<std::function<void(entityx::Entity thisEntity, entityx::Entity overlappingEntity)> > mDuringEachOverlapFns;
@@ -1,32 +1,65 @@
 #pragma once
 
+#include <vector>
 #include "entityx/Entity.h"
 #include "cinder/Vector.h"
 
 namespace sitara {
 	namespace ecs {
+		/*
+		* While a ParticleSystem is configured, live particles are simulated in its structure-of-arrays buffer; position,
+		* velocity and age are copied back here after every update.  Changes made through the setters, addForce(),
+		* reset() and kill() are queued and picked up on the next update.
+		*/
 		class Particle {
 		public:
 			Particle(float mass) {
 				mMass = mass;
 				mPosition = ci::vec3(0);
+				mLifetime = 0.0f;
+				mSlot = -1;
+				mChanged = false;
+				mChangedParticles = nullptr;
 				reset();
 			}
 
 			Particle(float mass, float x, float y, float z) {
 				mMass = mass;
 				mPosition = ci::vec3(x, y, z);
+				mLifetime = 0.0f;
+				mSlot = -1;
+				mChanged = false;
+				mChangedParticles = nullptr;
 				reset();
 			}
 
 			Particle(float mass, const ci::vec3& position) {
 				mMass = mass;
 				mPosition = position;
+				mLifetime = 0.0f;
+				mSlot = -1;
+				mChanged = false;
+				mChangedParticles = nullptr;
 				reset();
 			}
 
+			// a copy is a plain value; only the component itself is registered with a ParticleSystem
+			Particle(const Particle& other) {
+				copyState(other);
+				mSlot = -1;
+				mChanged = false;
+				mChangedParticles = nullptr;
+			}
+
+			Particle& operator=(const Particle& other) {
+				copyState(other);
+				markChanged();
+				return *this;
+			}
+
 			void setMass(float mass) {
 				mMass = mass;
+				markChanged();
 			}
 
 			float getMass() {
@@ -49,60 +82,113 @@ namespace sitara {
 				return mIsAlive;
 			}
 
-			int getAge() {
+			void kill() {
+				mIsAlive = false;
+				markChanged();
+			}
+
+			// seconds since the particle was last reset
+			float getAge() {
 				return mAge;
 			}
 
-			ci::vec3& getPosition() {
+			// a lifetime of zero or less means the particle never expires
+			void setLifetime(float seconds) {
+				mLifetime = seconds;
+				markChanged();
+			}
+
+			float getLifetime() {
+				return mLifetime;
+			}
+
+			const ci::vec3& getPosition() {
 				return mPosition;
 			}
 
-			ci::vec3& getVelocity() {
+			void setPosition(const ci::vec3& position) {
+				mPosition = position;
+				markChanged();
+			}
+
+			const ci::vec3& getVelocity() {
 				return mVelocity;
 			}
 
+			void setVelocity(const ci::vec3& velocity) {
+				mVelocity = velocity;
+				markChanged();
+			}
+
+			// applied on the next update, then cleared
 			void addForce(const ci::vec3& force) {
 				mForces = mForces + force;
+				markChanged();
 			}
 
 			ci::vec3& getForces() {
 				return mForces;
 			}
 
-			void reset(const ci::vec3& position = ci::vec3(0), const ci::vec3& velocity = ci::vec3(0)) {
+			// revives the particle where it is, at rest
+			void reset() {
 				mVelocity = ci::vec3(0);
 				mForces = ci::vec3(0);
-				mAge = -1;
+				mAge = 0.0f;
 				mIsAlive = true;
 				mIsFree = true;
+				markChanged();
 			}
 
-		protected:
-
-			void setPosition(const ci::vec3& position) {
+			void reset(const ci::vec3& position, const ci::vec3& velocity = ci::vec3(0)) {
 				mPosition = position;
-			}
-
-			void setVelocity(const ci::vec3& velocity) {
+				reset();
 				mVelocity = velocity;
 			}
 
+		protected:
+
 			void clearForces() {
 				mForces = ci::vec3(0);
 			}
 
-			void setAge(int age) {
+			void setAge(float age) {
 				mAge = age;
 			}
 
+			void copyState(const Particle& other) {
+				mPosition = other.mPosition;
+				mVelocity = other.mVelocity;
+				mForces = other.mForces;
+				mMass = other.mMass;
+				mAge = other.mAge;
+				mLifetime = other.mLifetime;
+				mIsAlive = other.mIsAlive;
+				mIsFree = other.mIsFree;
+			}
+
+			// queues the particle for ParticleSystem to copy into its buffer, once per update
+			void markChanged() {
+				if (mChangedParticles && !mChanged) {
+					mChanged = true;
+					mChangedParticles->push_back(this);
+				}
+			}
+
 			ci::vec3 mPosition;
 			ci::vec3 mVelocity;
 			ci::vec3 mForces;
 			float mMass;
-			int mAge;
+			float mAge;
+			float mLifetime;
 			bool mIsAlive;
 			bool mIsFree;
 
+			int32_t mSlot;									// index in ParticleSystem's buffer while alive, otherwise -1
+			bool mChanged;
+			std::vector<Particle*>* mChangedParticles;		// owned by the ParticleSystem that registered this particle
+			entityx::Entity mEntity;
+
 			friend class ParticleSystem;
 		};
 	}
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <vector>
 #include "entityx/System.h"
 #include "Particle.h"
 #include "Attractor.h"
 #include "Spring.h"
+#include "Emitter.h"
+#include "AttractorTree.h"
+#include "transform/Transform.h"
 
 namespace sitara {
 	namespace ecs {
@@ -13,11 +17,62 @@ namespace sitara {
             ~ParticleSystem();
             void configure(entityx::EntityManager& entities, entityx::EventManager& events) override;
             void update(entityx::EntityManager& entities, entityx::EventManager& events, entityx::TimeDelta dt) override;
-            //void receive(const entityx::ComponentAddedEvent<Particle>& event);
-            //void receive(const entityx::ComponentRemovedEvent<Particle>& event);
+            void receive(const entityx::ComponentRemovedEvent<Emitter>& event);
+            void receive(const entityx::ComponentAddedEvent<Particle>& event);
+            void receive(const entityx::ComponentRemovedEvent<Particle>& event);
+            void receive(const entityx::ComponentAddedEvent<Transform>& event);
+            void receive(const entityx::ComponentRemovedEvent<Transform>& event);
             //void receive(const entityx::ComponentAddedEvent<Spring>& event);
             //void receive(const entityx::ComponentRemovedEvent<Spring>& event);
             double getElapsedSimulationTime();
+
+            /*
+            * With approximation on, scenes with at least minimumAttractors active attractors evaluate them through a
+            * Barnes-Hut octree instead of one pass per attractor.  theta trades accuracy for speed (0 is exact,
+            * 0.5 is a good default); smaller scenes always take the exact path.
+            */
+            void enableAttractorApproximation(bool enable, float theta = 0.5f, size_t minimumAttractors = 32);
+            bool isAttractorApproximationEnabled();
+        private:
+            /*
+            * Structure-of-arrays store of every live Particle, so that drag, attractors and integration run as
+            * straight-line SIMD loops.  Slots persist across updates: particles join when they are added or revived,
+            * leave when they die or are removed (swap-remove), and only components queued through
+            * Particle::markChanged() are copied in.
+            */
+            struct ParticleBuffer {
+                void add(Particle* particle, Transform* transform);
+                void remove(size_t slot);
+                void clearForces();
+                size_t size() const;
+
+                std::vector<float> mPositionX, mPositionY, mPositionZ;
+                std::vector<float> mVelocityX, mVelocityY, mVelocityZ;
+                std::vector<float> mForceX, mForceY, mForceZ;
+                std::vector<float> mMass, mAge, mLifetime;
+                std::vector<Particle*> mParticles;
+                std::vector<Transform*> mTransforms;
+            };
+
+            void updateEmitters(entityx::EntityManager& entities, float dt);
+            void buildEmitterPool(entityx::EntityManager& entities, entityx::ComponentHandle<Emitter> emitter);
+            entityx::Entity createPoolEntity(entityx::EntityManager& entities, entityx::ComponentHandle<Emitter> emitter);
+            void syncChangedParticles();
+            void applyAttractors(entityx::EntityManager& entities);
+            void applySprings(entityx::EntityManager& entities);
+            void ageParticles(float dt);
+            void integrateParticles(float dt);
+            void writeParticles();
+
+            ParticleBuffer mBuffer;
+            std::vector<Particle*> mChangedParticles;
+            std::vector<size_t> mExpiredSlots;
+
+            bool mApproximateAttractors;
+            size_t mApproximationThreshold;
+            AttractorTree mAttractorTree;
+            std::vector<ci::vec3> mAttractorPositions;
+            std::vector<ci::vec3> mAttractorStrengths;
         };
     }
 }
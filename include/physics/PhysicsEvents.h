@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "entityx/Entity.h"
+#include "cinder/Vector.h"
+#include "physics/PhysicsUtils.h"
+
+namespace sitara {
+	namespace ecs {
+		namespace physics {
+			// bits in a shape's simulation filter data word2
+			enum FilterFlag : physx::PxU32 {
+				REPORT_CONTACTS = 1 << 0
+			};
+		}
+
+		/*
+		* A body entered or left a trigger shape (see DynamicBody/StaticBody::setTrigger()).
+		*/
+		struct TriggerEvent {
+			entityx::Entity mTrigger;
+			entityx::Entity mOther;
+			bool mEntered;
+		};
+
+		/*
+		* Two shapes started or stopped touching.  Only reported for pairs where at least one body called
+		* enableContactReports(); mPoint and mNormal come from the first contact point of the pair.
+		*/
+		struct ContactEvent {
+			entityx::Entity mFirst;
+			entityx::Entity mSecond;
+			bool mBegan;
+			ci::vec3 mPoint;
+			ci::vec3 mNormal;
+		};
+
+		/*
+		* PhysicsSystem emits these at most once per update, with every pair PhysX reported since the previous update.
+		* Subscribe with events.subscribe<TriggerEvents>(receiver).  The vectors are only valid inside receive().
+		*/
+		struct TriggerEvents {
+			TriggerEvents(const std::vector<TriggerEvent>& triggers) : mTriggers(triggers) {
+			}
+
+			const std::vector<TriggerEvent>& mTriggers;
+		};
+
+		struct ContactEvents {
+			ContactEvents(const std::vector<ContactEvent>& contacts) : mContacts(contacts) {
+			}
+
+			const std::vector<ContactEvent>& mContacts;
+		};
+
+		/*
+		* Buffers trigger and contact pairs while PhysX runs fetchResults(); PhysicsSystem turns them into entity events
+		* afterwards, once it's safe to touch the EntityManager.  The ids come from the actors' userData.
+		*/
+		class SimulationEventBuffer : public physx::PxSimulationEventCallback {
+		public:
+			struct TriggerPair {
+				entityx::Entity::Id mTrigger;
+				entityx::Entity::Id mOther;
+				bool mEntered;
+			};
+
+			struct ContactPair {
+				entityx::Entity::Id mFirst;
+				entityx::Entity::Id mSecond;
+				bool mBegan;
+				ci::vec3 mPoint;
+				ci::vec3 mNormal;
+			};
+
+			void onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count) override {
+				for (physx::PxU32 i = 0; i < count; i++) {
+					const physx::PxTriggerPair& pair = pairs[i];
+					if (pair.flags & (physx::PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER | physx::PxTriggerPairFlag::eREMOVED_SHAPE_OTHER)) {
+						continue;
+					}
+
+					TriggerPair trigger;
+					trigger.mTrigger = entityx::Entity::Id((uint64_t)(pair.triggerActor->userData));
+					trigger.mOther = entityx::Entity::Id((uint64_t)(pair.otherActor->userData));
+					trigger.mEntered = (pair.status == physx::PxPairFlag::eNOTIFY_TOUCH_FOUND);
+					mTriggers.push_back(trigger);
+				}
+			}
+
+			void onContact(const physx::PxContactPairHeader& header, const physx::PxContactPair* pairs, physx::PxU32 count) override {
+				if (header.flags & (physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_0 | physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_1)) {
+					return;
+				}
+
+				for (physx::PxU32 i = 0; i < count; i++) {
+					const physx::PxContactPair& pair = pairs[i];
+					if (!(pair.events & (physx::PxPairFlag::eNOTIFY_TOUCH_FOUND | physx::PxPairFlag::eNOTIFY_TOUCH_LOST))) {
+						continue;
+					}
+
+					ContactPair contact;
+					contact.mFirst = entityx::Entity::Id((uint64_t)(header.actors[0]->userData));
+					contact.mSecond = entityx::Entity::Id((uint64_t)(header.actors[1]->userData));
+					contact.mBegan = (pair.events & physx::PxPairFlag::eNOTIFY_TOUCH_FOUND);
+					contact.mPoint = ci::vec3(0);
+					contact.mNormal = ci::vec3(0);
+
+					physx::PxContactPairPoint point;
+					if (pair.contactCount > 0 && pair.extractContacts(&point, 1) > 0) {
+						contact.mPoint = sitara::ecs::physics::from(point.position);
+						contact.mNormal = sitara::ecs::physics::from(point.normal);
+					}
+					mContacts.push_back(contact);
+				}
+			}
+
+			void onConstraintBreak(physx::PxConstraintInfo* constraints, physx::PxU32 count) override {
+			}
+
+			void onWake(physx::PxActor** actors, physx::PxU32 count) override {
+			}
+
+			void onSleep(physx::PxActor** actors, physx::PxU32 count) override {
+			}
+
+			void onAdvance(const physx::PxRigidBody* const* bodies, const physx::PxTransform* poses, const physx::PxU32 count) override {
+			}
+
+			void clear() {
+				mTriggers.clear();
+				mContacts.clear();
+			}
+
+			std::vector<TriggerPair> mTriggers;
+			std::vector<ContactPair> mContacts;
+		};
+
+		/*
+		* Collects bodies that left every MBP broadphase region during a step; they stop colliding until they come back.
+		*/
+		class BroadPhaseEventBuffer : public physx::PxBroadPhaseCallback {
+		public:
+			void onObjectOutOfBounds(physx::PxShape& shape, physx::PxActor& actor) override {
+				mOutOfBounds.push_back(entityx::Entity::Id((uint64_t)(actor.userData)));
+			}
+
+			void onObjectOutOfBounds(physx::PxAggregate& aggregate) override {
+				mAggregateActors.resize(aggregate.getNbActors());
+				aggregate.getActors(mAggregateActors.data(), static_cast<physx::PxU32>(mAggregateActors.size()));
+				for (auto actor : mAggregateActors) {
+					mOutOfBounds.push_back(entityx::Entity::Id((uint64_t)(actor->userData)));
+				}
+			}
+
+			std::vector<entityx::Entity::Id> mOutOfBounds;
+
+		private:
+			std::vector<physx::PxActor*> mAggregateActors;
+		};
+	}
+}
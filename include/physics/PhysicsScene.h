@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sitara {
+	namespace ecs {
+		/*
+		* Binds an entity's body and OverlapDetector to one of PhysicsSystem's scenes (see PhysicsSystem::createScene()).
+		* Entities without one live in scene 0.  To move a body to another scene, remove the component and assign a new one.
+		*/
+		struct PhysicsScene {
+		public:
+			PhysicsScene() = delete;
+
+			PhysicsScene(uint32_t sceneIndex) : mSceneIndex(sceneIndex) {
+			}
+
+			uint32_t mSceneIndex;
+		};
+	}
+}
@@ -1,13 +1,27 @@
 #pragma once
 
+#include <array>
 #include <map>
+#include <memory>
+#include <string>
+#include <tuple>
 #include "entityx/System.h"
 #include "cinder/Vector.h"
+#include "cinder/TriMesh.h"
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Filesystem.h"
 #include "PxPhysicsAPI.h"
 #include "extensions/PxExtensionsAPI.h"
 #include "physics/DynamicBody.h"
 #include "physics/StaticBody.h"
 #include "physics/OverlapDetector.h"
+#include "physics/PhysicsEvents.h"
+#include "physics/BodyTemplate.h"
+#include "physics/JobPoolDispatcher.h"
+#include "physics/TrackingAllocator.h"
+#include "physics/PhysicsScene.h"
+#include "logic/LogicalLayer.h"
+#include "utilities/JobPool.h"
 
 PX_C_EXPORT bool PX_CALL_CONV PxInitExtensions(physx::PxPhysics& physics, physx::PxPvd* pvd);
 
@@ -15,6 +29,45 @@ namespace sitara {
 	namespace ecs {
 		class PhysicsSystem : public entityx::System<PhysicsSystem>, public entityx::Receiver<PhysicsSystem> {
 		public:
+			/*
+			* Collision cost per update, for comparing broadphase setups on a real layout.  mCollisionTime covers
+			* collide() + fetchCollision(), i.e. broadphase plus narrowphase, which is where SAP pair management shows up.
+			*/
+			struct BroadPhaseStats {
+				physx::PxBroadPhaseType::Enum mType;
+				uint32_t mRegions;
+				uint32_t mSteps;
+				double mCollisionTime;		// milliseconds, summed over the update's steps
+				uint32_t mAdds;
+				uint32_t mRemoves;
+				uint32_t mContactPairs;		// discrete contact pairs in the last step
+				uint32_t mOutOfBounds;
+			};
+
+			/*
+			* What the scene did during the last update(), from PxSimulationStatistics plus wall time around the PhysX
+			* calls.  Body and pair counts describe the update's last step; times and broadphase counts are summed over
+			* its steps.  mFetchTime is how long update() blocked on results -- in async mode only the part of the step
+			* that didn't overlap the app's frame.
+			*/
+			struct SimulationStats {
+				uint32_t mSteps;
+				double mSimulateTime;			// milliseconds
+				double mFetchTime;				// milliseconds
+				uint32_t mDynamicBodies;
+				uint32_t mActiveDynamicBodies;
+				uint32_t mActiveKinematicBodies;
+				uint32_t mStaticBodies;
+				uint32_t mBroadPhaseAdds;
+				uint32_t mBroadPhaseRemoves;
+				uint32_t mContactPairs;			// pairs past the broadphase and filtering
+				uint32_t mTouchingPairs;		// of those, pairs with contact points
+				uint32_t mNewTouches;
+				uint32_t mLostTouches;
+				size_t mLiveBytes;				// PhysX heap use at the end of the update
+				size_t mPeakBytes;
+			};
+
 			PhysicsSystem();
 			~PhysicsSystem();
 			void configure(entityx::EntityManager& entities, entityx::EventManager& events) override;
@@ -23,32 +76,311 @@ namespace sitara {
 			void receive(const entityx::ComponentRemovedEvent<DynamicBody>& event);
 			void receive(const entityx::ComponentAddedEvent<StaticBody>& event);
 			void receive(const entityx::ComponentRemovedEvent<StaticBody>& event);
+			void receive(const entityx::ComponentAddedEvent<LogicalLayer>& event);
+			void receive(const entityx::ComponentAddedEvent<PhysicsScene>& event);
 			double getElapsedSimulationTime();
 			void setGravity(const ci::vec3& gravity);
+			/*
+			* Broadphase options; set them before configure().  MBP needs world bounds, which are split into
+			* subdivisions x subdivisions regions over the ground plane (y up), at most 16 x 16.  Bodies that leave every
+			* region stop colliding and are handed to the out-of-bounds function after the step.
+			*/
+			void setBroadPhase(physx::PxBroadPhaseType::Enum type);
+			void setWorldBounds(const ci::AxisAlignedBox& bounds, uint32_t subdivisions = 4);
+			void setOutOfBoundsFn(std::function<void(entityx::Entity entity)> callback);
+			// steps through collide()/advance() so collision time can be measured separately
+			void enableBroadPhaseProfiling(const bool enable);
+			const BroadPhaseStats& getBroadPhaseStats(uint32_t sceneIndex = 0);
+			/*
+			* PhysX Visual Debugger capture is off unless one of these is called before configure(): stream to a running
+			* PVD over a socket, or write a .pxd2 file to open in PVD later.
+			*/
+			void enableVisualDebugger(const std::string& host = "127.0.0.1", int port = 5425, unsigned int timeoutMs = 10,
+									  physx::PxPvdInstrumentationFlags flags = physx::PxPvdInstrumentationFlag::eALL);
+			void captureVisualDebuggerToFile(const ci::fs::path& path, physx::PxPvdInstrumentationFlags flags = physx::PxPvdInstrumentationFlag::eALL);
+			void enableSimulationStats(const bool enable);
+			const SimulationStats& getSimulationStats(uint32_t sceneIndex = 0);
+			/*
+			* Extra PhysX scenes for regions whose bodies never interact, like separate rooms or screens.  Each scene has
+			* its own broadphase, solver islands, overlap queries and statistics.  update() starts every scene before
+			* fetching any, so their tasks run side by side on the workers.  Put an entity in a scene with a PhysicsScene
+			* component; entities without one stay in scene 0.  Call after configure().
+			*/
+			uint32_t createScene();
+			uint32_t getNumberOfScenes();
+			physx::PxScene* getScene(uint32_t sceneIndex = 0);
+			/*
+			* PhysX allocates through a TrackingAllocator.  Allocation names make getMemoryStats() break usage down by
+			* object type, at some cost per allocation; pooling serves blocks up to 512 bytes from reusable arenas.
+			*/
+			void enableAllocationNames(const bool enable);
+			void enablePooledAllocations(const bool enable);
+			MemoryStats getMemoryStats();
+			/*
+			* By default PhysX runs its tasks on the shared JobPool (or the one given to setJobPool() before configure()).
+			* A non-zero thread count gives PhysX its own PxDefaultCpuDispatcher with that many threads instead.
+			*/
 			void setNumberOfThreads(const uint32_t numThreads);
 			void enableGpu(const bool enable);
-			physx::PxRigidStatic* createStaticBody(const ci::vec3& position, const ci::quat& rotation = ci::quat());
-			physx::PxRigidDynamic* createDynamicBody(const ci::vec3& position, const ci::quat& rotation = ci::quat());
+			physx::PxRigidStatic* createStaticBody(const ci::vec3& position, const ci::quat& rotation = ci::quat(), uint32_t sceneIndex = 0);
+			physx::PxRigidDynamic* createDynamicBody(const ci::vec3& position, const ci::quat& rotation = ci::quat(), uint32_t sceneIndex = 0);
+			/*
+			* Spawns one entity with a DynamicBody (or StaticBody) per position, all built from bodyTemplate, and inserts every
+			* actor with a single addActors() call.  With aggregateSize > 0 dynamic bodies are grouped, in order, into
+			* PxAggregates of that many actors (at most 128) without self collision -- useful for debris that spawns
+			* together, since the broadphase then only tracks one box per group.  Bodies go straight into sceneIndex, and
+			* the entities get a matching PhysicsScene.
+			*/
+			std::vector<entityx::Entity> createDynamicBodies(entityx::EntityManager& entities, const BodyTemplate& bodyTemplate,
+															 const std::vector<ci::vec3>& positions, uint32_t aggregateSize = 0, uint32_t sceneIndex = 0);
+			std::vector<entityx::Entity> createStaticBodies(entityx::EntityManager& entities, const BodyTemplate& bodyTemplate,
+															const std::vector<ci::vec3>& positions, uint32_t sceneIndex = 0);
+			/*
+			* With pooling on, DynamicBodies built from a BodyTemplate (here or through createDynamicBodies()) don't release
+			* their actor when removed.  The actor is taken out of the scene and parked, up to maxParkedPerTemplate per
+			* template, and the next body with the same template reuses it after a resetBody()-style reinitialization.
+			*/
+			void enableBodyPooling(const bool enable, size_t maxParkedPerTemplate = 1024);
+			entityx::ComponentHandle<DynamicBody> assignDynamicBody(entityx::Entity entity, const BodyTemplate& bodyTemplate,
+																	const ci::vec3& position, const ci::quat& rotation = ci::quat());
+			/*
+			* Moves the bodies of already spawned entities (e.g. the parts of a compound object) into one aggregate.
+			*/
+			physx::PxAggregate* createAggregate(const std::vector<entityx::Entity>& group, bool selfCollision = true);
 			physx::PxDistanceJoint* createSpring(entityx::ComponentHandle<sitara::ecs::DynamicBody> body, ci::vec3 anchorPoint, float stiffness, float dampingConstant);
 			int registerMaterial(const float staticFriction, const float dynamicFriction, const float restitution);
 			physx::PxMaterial* getMaterial(const int materialId);
-			//int registerShape(const float staticFriction, const float dynamicFriction, const float restitution);
-			//physx::PxShape* getShape(const int shapeId);
+			/*
+			* Cooks a PhysX mesh from a TriMesh (use geometry::getMesh() for a ci::geom::Source).  Meshes are keyed by a
+			* hash of their vertices and indices: the same data returns the same mesh, and the cooked bytes are kept in
+			* the cooking cache directory so the next launch loads them instead of cooking again.
+			* Triangle meshes can only be attached to static (or kinematic) bodies.
+			*/
+			physx::PxConvexMesh* cookConvexMesh(const ci::TriMesh& mesh);
+			physx::PxTriangleMesh* cookTriangleMesh(const ci::TriMesh& mesh);
+			// defaults to <app folder>/cooked; an empty path keeps cooked meshes in memory only
+			void setCookingCacheDirectory(const ci::fs::path& directory);
+			/*
+			* Shared shapes for attachShape(), one per mesh/material/scale combination, reused by every body that asks
+			* for the same one.  Don't change their flags (setTrigger etc.) -- that would change every body using them.
+			*/
+			physx::PxShape* getSharedShape(physx::PxConvexMesh* mesh, physx::PxMaterial* material, const ci::vec3& scale = ci::vec3(1.0f));
+			physx::PxShape* getSharedShape(physx::PxTriangleMesh* mesh, physx::PxMaterial* material, const ci::vec3& scale = ci::vec3(1.0f));
+			/*
+			* Writes every actor in scene 0, with its shapes, materials, meshes and joints, to a PhysX binary collection.
+			* Actors owned by a DynamicBody/StaticBody are tagged with their entity's id.
+			*/
+			bool saveSnapshot(entityx::EntityManager& entities, const ci::fs::path& path);
+			/*
+			* Adds a saved snapshot to the scene.  Statics go in through one precomputed pruning structure and dynamics through
+			* a single addActors() call.  Every tagged actor gets a new entity with a DynamicBody or StaticBody (and Transform);
+			* onEntityFn receives it along with the id of the entity it was saved from, so the app can re-attach the rest.
+			*/
+			bool loadSnapshot(entityx::EntityManager& entities, const ci::fs::path& path,
+							  std::function<void(entityx::Entity entity, uint64_t savedEntityId)> onEntityFn = nullptr);
+			/*
+			* Steps the scene in increments of stepSize, carrying the remainder of dt over to the next update, and writes
+			* Transforms interpolated between the last two steps.  At most maxSubSteps run per update; anything beyond that
+			* is dropped so a hitch can't snowball.  Pre-update callbacks run before every step, so forces applied there
+			* act on each step -- forces applied elsewhere only reach the first step of the frame.
+			* A stepSize of 0 goes back to simulating the raw dt.
+			*/
+			void setFixedTimeStep(float stepSize, uint32_t maxSubSteps = 4);
+			float getFixedTimeStep();
+			float getInterpolationAlpha();
+			/*
+			* Pipelines the simulation with the rest of the frame: update() fetches the step started during the previous
+			* update, syncs Transforms and runs the overlap queries from that completed state, then starts the next step
+			* and returns without waiting for it.  Transforms therefore trail the simulation by one update.
+			* Between updates the scene is simulating; PhysX buffers writes (forces, poses, new actors) until the next
+			* step and reads return the last completed state.
+			*/
+			void enableAsyncSimulation(const bool enable);
+			bool isAsyncSimulationEnabled();
+			// pool for PhysX tasks and OverlapDetector batch queries; defaults to JobPool::getInstance()
+			void setJobPool(JobPool* pool);
+			void enableMultithreadedQueries(const bool enable);
+			/*
+			* Only re-query an OverlapDetector when its pose or filter changed, a body it could see (same scene, static/
+			* dynamic flags and layer mask) moved, was added, removed or relayered within its bounds, or a body in its last
+			* result changed.  Otherwise it keeps its previous overlaps and only gets "during" callbacks.
+			*/
+			void enableIncrementalOverlaps(const bool enable);
 			void setMaximumLinearVelocity(entityx::Entity& entity, float maximumVelocity);
+			/*
+			* Kinematic bodies ignore forces and collisions and follow their Transform instead: every step the Transform
+			* becomes a kinematic target, so the body sweeps there and pushes dynamic bodies out of the way rather than
+			* teleporting through them.  Animate them by moving or tweening the Transform.
+			*/
+			void setKinematic(entityx::Entity& entity, bool kinematic);
+			/*
+			* Layer collision matrix keyed by LogicalLayer::mLayerId (0-31).  Every pair of layers collides until told
+			* otherwise, and bodies without a LogicalLayer collide with everything.  Pairs between layers that don't
+			* interact are killed as soon as the broadphase reports them, so they never reach the narrowphase.
+			* Bodies pick up their layer on the next update; call refreshCollisionLayer() after changing mLayerId or
+			* attaching shapes to a body that already has one.  Shared shapes carry a single layer for all their bodies.
+			*/
+			void setLayerCollision(int layerA, int layerB, bool collide);
+			bool getLayerCollision(int layerA, int layerB);
+			void refreshCollisionLayer(entityx::Entity entity);
+			/*
+			* Moving a PxRigidStatic rebuilds its broadphase and query entries every time.  With promotion on, a StaticBody
+			* moved in promotionThreshold consecutive updates is replaced by a kinematic DynamicBody (same actor pose and
+			* shapes) that follows the entity's Transform from then on.
+			*/
+			void enableStaticPromotion(const bool enable, uint32_t promotionThreshold = 8);
 			void addPreUpdateFn(std::function<void(entityx::ComponentHandle<sitara::ecs::DynamicBody>)> callback);
 			void addPostUpdateFn(std::function<void(entityx::ComponentHandle<sitara::ecs::DynamicBody>)> callback);
 		private:
-			physx::PxDefaultAllocator mAllocator;
+			/*
+			* One PhysX scene and everything that has to be kept per scene: its event buffers are filled while it fetches,
+			* batch queries belong to it, and its statistics describe it alone.
+			*/
+			struct SceneState {
+				physx::PxScene* mScene;
+				SimulationEventBuffer mSimulationEvents;
+				BroadPhaseEventBuffer mBroadPhaseEvents;
+				std::vector<physx::PxBatchQuery*> mBatchQueries;
+				// copied from getActiveActors() at fetchResults(); PhysX's own list goes stale as soon as the scene changes
+				std::vector<entityx::Entity::Id> mActiveEntities;
+				std::vector<physx::PxRigidDynamic*> mActiveActors;
+				SimulationStats mSimulationStats;
+				SimulationStats mLastSimulationStats;
+				BroadPhaseStats mBroadPhaseStats;
+				BroadPhaseStats mLastBroadPhaseStats;
+			};
+
+			struct OverlapBatch {
+				size_t mBegin;
+				size_t mEnd;
+				physx::PxBatchQuery* mQuery;
+			};
+
+			// a body's bounds with what an OverlapDetector's filter needs to know about it
+			struct TrackedBounds {
+				physx::PxBounds3 mBounds;
+				physx::PxU32 mLayer;		// query filter word0 of its shapes (LogicalLayer bit, or 0)
+				physx::PxScene* mScene;
+				bool mStatic;
+			};
+
+			void runPreUpdateFns(entityx::EntityManager& entities);
+			void stepSimulation(entityx::EntityManager& entities, float dt, bool async);
+			void syncDynamicBodies(entityx::EntityManager& entities);
+			void gatherActiveBodies(entityx::EntityManager& entities);
+			void driveKinematicBodies(uint32_t remainingSteps);
+			void removeKinematicBody(entityx::Entity::Id id);
+			void promoteStaticBody(entityx::Entity entity);
+			void applyCollisionLayers(entityx::EntityManager& entities);
+			void fetchPendingResults();
+			void simulateStep(float dt, bool async);
+			void fetchStepResults();
+			void fetchStepResults(SceneState& sceneState);
+			void addScene();
+			uint32_t getSceneIndex(entityx::Entity entity);
+			uint32_t validateSceneIndex(uint32_t sceneIndex);
+			void bindToScene(entityx::Entity entity);
+			// releases the actor's aggregate once its last actor has left
+			void removeFromAggregate(physx::PxRigidActor& actor);
+			void handleOutOfBounds(entityx::EntityManager& entities);
+			void updateOverlapDetectors(entityx::EntityManager& entities);
+			void emitOverlapCallbacks(entityx::EntityManager& entities, entityx::ComponentHandle<sitara::ecs::OverlapDetector> overlapDetector);
+			bool needsOverlapQuery(entityx::ComponentHandle<sitara::ecs::OverlapDetector> overlapDetector, uint32_t sceneIndex);
+			void gatherActiveBounds(entityx::EntityManager& entities);
+			void invalidateOverlaps(physx::PxRigidActor* actor, entityx::Entity::Id id, physx::PxU32 previousLayer = 0);
+			TrackedBounds getTrackedBounds(physx::PxRigidActor* actor);
+			void sortTrackedBounds(std::vector<TrackedBounds>& tracked, float& maxWidth);
+			bool intersectsTracked(const std::vector<TrackedBounds>& tracked, float maxWidth, const physx::PxBounds3& bounds,
+								   physx::PxScene* scene, const physx::PxQueryFilterData& filter);
+			void emitSimulationEvents(entityx::EntityManager& entities, entityx::EventManager& events);
+			bool loadCookedMesh(const ci::fs::path& path, std::vector<uint8_t>& data);
+			void saveCookedMesh(const ci::fs::path& path, const physx::PxDefaultMemoryOutputStream& data);
+			physx::PxShape* getSharedShape(const physx::PxGeometry& geometry, const void* mesh, physx::PxMaterial* material, const ci::vec3& scale);
+			physx::PxRigidDynamic* acquireActor(const BodyTemplate& bodyTemplate, const physx::PxTransform& pose, int& poolIndex, physx::PxShape*& shape);
+
+			struct BodyPool {
+				BodyTemplate mTemplate;
+				std::vector<physx::PxRigidDynamic*> mParked;
+			};
+
+			TrackingAllocator mAllocator;
+			bool mReportAllocationNames;
 			physx::PxDefaultErrorCallback mErrorCallback;
 			physx::PxFoundation* mFoundation;
 			physx::PxPhysics* mPhysics;
 			physx::PxDefaultCpuDispatcher* mDispatcher;
+			std::unique_ptr<JobPoolDispatcher> mJobDispatcher;
 			physx::PxCudaContextManager* mCudaContext;
-			physx::PxScene* mScene;
+			physx::PxScene* mScene;		// scene 0
+			std::vector<std::unique_ptr<SceneState>> mScenes;
 			physx::PxPvd* mPvd;
+			bool mPvdEnabled;
+			std::string mPvdHost;
+			int mPvdPort;
+			unsigned int mPvdTimeout;
+			ci::fs::path mPvdFile;
+			physx::PxPvdInstrumentationFlags mPvdFlags;
+			bool mSimulationStatsEnabled;
+			physx::PxCooking* mCooking;
+			physx::PxSerializationRegistry* mSerializationRegistry;
+			std::vector<physx::PxAggregate*> mAggregates;
+			bool mBodyPooling;
+			size_t mMaxParkedBodies;
+			std::vector<BodyPool> mBodyPools;
+			std::vector<std::unique_ptr<uint8_t[]>> mSnapshotMemory;
+			ci::fs::path mCookingCacheDirectory;
+			bool mCookingCacheDirectorySet;
+			std::map<uint64_t, physx::PxConvexMesh*> mConvexMeshes;
+			std::map<uint64_t, physx::PxTriangleMesh*> mTriangleMeshes;
+			std::map<std::tuple<const void*, physx::PxMaterial*, float, float, float>, physx::PxShape*> mSharedShapes;
 			bool mGpuEnabled;
 			uint32_t mNumberOfThreads;
 			float mSimulationTime;
+			float mFixedTimeStep;
+			uint32_t mMaxSubSteps;
+			float mAccumulator;
+			float mInterpolationAlpha;
+			bool mAsyncSimulation;
+			bool mSimulationPending;
+			std::vector<entityx::ComponentHandle<sitara::ecs::DynamicBody>> mActiveBodies;
+			std::vector<entityx::Entity::Id> mSyncedBodies;
+			std::vector<entityx::Entity::Id> mPreviousSyncedBodies;
+			std::vector<entityx::ComponentHandle<sitara::ecs::DynamicBody>> mKinematicBodies;
+			bool mStaticPromotion;
+			uint32_t mPromotionThreshold;
+			std::vector<entityx::Entity> mPromotedStatics;
+			std::array<physx::PxU32, 32> mLayerMasks;
+			bool mLayerMasksChanged;
+			std::vector<entityx::Entity::Id> mPendingLayerEntities;
+			JobPool* mJobPool;
+			bool mMultithreadedQueries;
+			static const size_t mOverlapBatchSize = 32;
+			std::vector<entityx::ComponentHandle<sitara::ecs::OverlapDetector>> mOverlapDetectors;
+			std::vector<uint32_t> mOverlapDetectorScenes;
+			std::vector<std::pair<uint32_t, entityx::ComponentHandle<sitara::ecs::OverlapDetector>>> mOverlapQueue;
+			std::vector<OverlapBatch> mOverlapBatches;
+			bool mIncrementalOverlaps;
+			bool mOverlapSceneChanged;		// every detector queries again, e.g. after incremental mode is switched on
+			std::vector<entityx::ComponentHandle<sitara::ecs::OverlapDetector>> mIdleOverlapDetectors;
+			std::vector<TrackedBounds> mActiveBounds;		// sorted by minimum.x
+			float mActiveBoundsWidth;
+			std::vector<TrackedBounds> mChangedBounds;		// added, removed, moved or relayered bodies; sorted by minimum.x
+			float mChangedBoundsWidth;
+			std::vector<entityx::Entity::Id> mChangedIds;
+			std::vector<entityx::Entity::Id> mAddedOverlapBodies;	// shapes usually come after the component; bounds are read at the next update
+			std::vector<entityx::Entity::Id> mActiveIds;
+			std::vector<size_t> mOverlapHitOffsets;
+			std::vector<physx::PxOverlapHit> mOverlapHits;
+			std::vector<physx::PxOverlapHit> mOverflowHits;
+			std::vector<physx::PxOverlapQueryResult> mOverlapResults;
+			std::vector<TriggerEvent> mTriggerEvents;
+			std::vector<ContactEvent> mContactEvents;
+			physx::PxBroadPhaseType::Enum mBroadPhaseType;
+			ci::AxisAlignedBox mWorldBounds;
+			uint32_t mWorldSubdivisions;
+			bool mHasWorldBounds;
+			std::function<void(entityx::Entity entity)> mOutOfBoundsFn;
+			bool mBroadPhaseProfiling;
 			std::map<int, physx::PxMaterial*> mMaterialRegistry;
 			uint32_t mMaterialCount;
 			std::vector<std::function<void(entityx::ComponentHandle<sitara::ecs::DynamicBody>)> > mPreUpdateFns;
@@ -4,6 +4,7 @@
 #include "entityx/Entity.h"
 #include "cinder/Vector.h"
 #include "physics/PhysicsUtils.h"
+#include "physics/PhysicsEvents.h"
 
 namespace sitara {
 	namespace ecs {
@@ -13,6 +14,7 @@ namespace sitara {
 				mBody = staticBody;
 				mShape = nullptr;
 				mIsDirty = true;
+				mMovedUpdates = 0;
 			}
 
 			~StaticBody() {
@@ -60,6 +62,52 @@ namespace sitara {
 				mShape = physx::PxRigidActorExt::createExclusiveShape(*mBody, physx::PxBoxGeometry(sitara::ecs::physics::to(halfEdges)), *material);
 			}
 
+			// mesh from PhysicsSystem::cookConvexMesh()
+			void attachConvexMesh(physx::PxConvexMesh* mesh, physx::PxMaterial* material, const ci::vec3& scale = ci::vec3(1.0f)) {
+				mShape = physx::PxRigidActorExt::createExclusiveShape(*mBody, physx::PxConvexMeshGeometry(mesh, physx::PxMeshScale(sitara::ecs::physics::to(scale))), *material);
+			}
+
+			// mesh from PhysicsSystem::cookTriangleMesh()
+			void attachTriangleMesh(physx::PxTriangleMesh* mesh, physx::PxMaterial* material, const ci::vec3& scale = ci::vec3(1.0f)) {
+				mShape = physx::PxRigidActorExt::createExclusiveShape(*mBody, physx::PxTriangleMeshGeometry(mesh, physx::PxMeshScale(sitara::ecs::physics::to(scale))), *material);
+			}
+
+			/*
+			* Turns the attached shape into a trigger: it stops colliding and PhysicsSystem emits TriggerEvents when
+			* other bodies enter or leave it.  Call after attaching a shape.
+			*/
+			void setTrigger(bool trigger) {
+				if (mShape) {
+					// a shape can't be a simulation shape and a trigger at the same time, so clear one before setting the other
+					if (trigger) {
+						mShape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, false);
+						mShape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, true);
+					}
+					else {
+						mShape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, false);
+						mShape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, true);
+					}
+				}
+			}
+
+			bool isTrigger() {
+				return mShape && mShape->getFlags().isSet(physx::PxShapeFlag::eTRIGGER_SHAPE);
+			}
+
+			// emit ContactEvents whenever the attached shape starts or stops touching another
+			void enableContactReports(bool enable) {
+				if (mShape) {
+					physx::PxFilterData filterData = mShape->getSimulationFilterData();
+					if (enable) {
+						filterData.word2 |= sitara::ecs::physics::REPORT_CONTACTS;
+					}
+					else {
+						filterData.word2 &= ~physx::PxU32(sitara::ecs::physics::REPORT_CONTACTS);
+					}
+					mShape->setSimulationFilterData(filterData);
+				}
+			}
+
 			const ci::vec3 getPosition() {
 				return sitara::ecs::physics::from(mBody->getGlobalPose().p);
 			}
@@ -97,6 +145,7 @@ namespace sitara {
 			physx::PxRigidStatic* mBody;
 			physx::PxShape* mShape;
 			bool mIsDirty;
+			uint32_t mMovedUpdates;		// consecutive updates the body was moved in; see PhysicsSystem::enableStaticPromotion()
 
 			friend class PhysicsSystem;
 		};
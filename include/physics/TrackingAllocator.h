@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "PxPhysicsAPI.h"
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace sitara {
+	namespace ecs {
+		/*
+		* Live and peak bytes for one PhysX allocation name.  PhysX only passes real names once
+		* PxFoundation::setReportAllocationNames(true) is on (PhysicsSystem::enableAllocationNames()); until then
+		* everything lands in one category.
+		*/
+		struct AllocationStats {
+			std::string mName;
+			size_t mLiveBytes;
+			size_t mPeakBytes;
+			size_t mLiveAllocations;
+			size_t mTotalAllocations;
+		};
+
+		struct MemoryStats {
+			size_t mLiveBytes;
+			size_t mPeakBytes;
+			size_t mPooledBytes;		// reserved by small-allocation arenas, used or not
+			std::vector<AllocationStats> mCategories;
+		};
+
+		/*
+		* PxAllocatorCallback that keeps per-name accounting, so slow growth in a long-running install can be traced to
+		* the kind of object that leaks.  Every block carries a 16 byte header with its size and category, which keeps
+		* the payload 16 byte aligned as PhysX requires.  With pooling on, blocks up to 512 bytes come from free lists
+		* carved out of 64 KiB arenas instead of the system heap; arenas are only returned when the allocator goes away,
+		* so it has to outlive the PxFoundation that uses it.
+		*/
+		class TrackingAllocator : public physx::PxAllocatorCallback {
+		public:
+			TrackingAllocator() {
+				mPooling = false;
+				mLiveBytes = 0;
+				mPeakBytes = 0;
+			}
+
+			~TrackingAllocator() {
+				for (auto arena : mArenas) {
+					alignedFree(arena);
+				}
+			}
+
+			void* allocate(size_t size, const char* typeName, const char* filename, int line) override {
+				size_t blockSize = size + sizeof(Header);
+
+				std::lock_guard<std::mutex> lock(mMutex);
+				int sizeClass = mPooling ? getSizeClass(blockSize) : -1;
+				void* block = (sizeClass >= 0) ? allocatePooled(sizeClass) : alignedAlloc(blockSize);
+				if (!block) {
+					return nullptr;
+				}
+
+				Header* header = static_cast<Header*>(block);
+				header->mSize = size;
+				header->mCategory = getCategory(typeName);
+				header->mSizeClass = sizeClass;
+
+				Category& category = mCategories[header->mCategory];
+				category.mLiveBytes += size;
+				category.mPeakBytes = std::max(category.mPeakBytes, category.mLiveBytes);
+				category.mLiveAllocations++;
+				category.mTotalAllocations++;
+				mLiveBytes += size;
+				mPeakBytes = std::max(mPeakBytes, mLiveBytes);
+
+				return header + 1;
+			}
+
+			void deallocate(void* ptr) override {
+				if (!ptr) {
+					return;
+				}
+
+				Header* header = static_cast<Header*>(ptr) - 1;
+				std::lock_guard<std::mutex> lock(mMutex);
+				Category& category = mCategories[header->mCategory];
+				category.mLiveBytes -= header->mSize;
+				category.mLiveAllocations--;
+				mLiveBytes -= header->mSize;
+
+				if (header->mSizeClass >= 0) {
+					mFreeLists[header->mSizeClass].push_back(header);
+				}
+				else {
+					alignedFree(header);
+				}
+			}
+
+			// only affects later allocations; pooled blocks already handed out go back to their pool either way
+			void enablePooling(bool enable) {
+				std::lock_guard<std::mutex> lock(mMutex);
+				mPooling = enable;
+			}
+
+			size_t getLiveBytes() {
+				std::lock_guard<std::mutex> lock(mMutex);
+				return mLiveBytes;
+			}
+
+			size_t getPeakBytes() {
+				std::lock_guard<std::mutex> lock(mMutex);
+				return mPeakBytes;
+			}
+
+			// categories that share a name (the same string from different modules) are merged
+			MemoryStats getStats() {
+				std::lock_guard<std::mutex> lock(mMutex);
+				MemoryStats stats;
+				stats.mLiveBytes = mLiveBytes;
+				stats.mPeakBytes = mPeakBytes;
+				stats.mPooledBytes = mArenas.size() * mArenaSize;
+
+				std::unordered_map<std::string, size_t> byName;
+				for (auto& category : mCategories) {
+					auto found = byName.find(category.mName);
+					if (found == byName.end()) {
+						byName[category.mName] = stats.mCategories.size();
+						stats.mCategories.push_back({ category.mName, category.mLiveBytes, category.mPeakBytes, category.mLiveAllocations, category.mTotalAllocations });
+					}
+					else {
+						AllocationStats& merged = stats.mCategories[found->second];
+						merged.mLiveBytes += category.mLiveBytes;
+						merged.mPeakBytes += category.mPeakBytes;
+						merged.mLiveAllocations += category.mLiveAllocations;
+						merged.mTotalAllocations += category.mTotalAllocations;
+					}
+				}
+				std::sort(stats.mCategories.begin(), stats.mCategories.end(), [](const AllocationStats& a, const AllocationStats& b) {
+					return a.mLiveBytes > b.mLiveBytes;
+				});
+				return stats;
+			}
+
+		private:
+			struct Header {
+				uint64_t mSize;
+				uint32_t mCategory;
+				int32_t mSizeClass;		// -1 for blocks from the system heap
+			};
+
+			struct Category {
+				std::string mName;
+				size_t mLiveBytes;
+				size_t mPeakBytes;
+				size_t mLiveAllocations;
+				size_t mTotalAllocations;
+			};
+
+			static const size_t mArenaSize = 64 * 1024;
+			static const int mSizeClassCount = 5;		// 32, 64, 128, 256 and 512 byte blocks
+
+			static void* alignedAlloc(size_t size) {
+#if defined(_WIN32)
+				return _aligned_malloc(size, 16);
+#else
+				void* block = nullptr;
+				return (posix_memalign(&block, 16, size) == 0) ? block : nullptr;
+#endif
+			}
+
+			static void alignedFree(void* block) {
+#if defined(_WIN32)
+				_aligned_free(block);
+#else
+				free(block);
+#endif
+			}
+
+			static int getSizeClass(size_t blockSize) {
+				size_t classSize = 32;
+				for (int sizeClass = 0; sizeClass < mSizeClassCount; sizeClass++, classSize *= 2) {
+					if (blockSize <= classSize) {
+						return sizeClass;
+					}
+				}
+				return -1;
+			}
+
+			void* allocatePooled(int sizeClass) {
+				std::vector<void*>& freeList = mFreeLists[sizeClass];
+				if (freeList.empty()) {
+					// carve a fresh arena into blocks of this class
+					char* arena = static_cast<char*>(alignedAlloc(mArenaSize));
+					if (!arena) {
+						return nullptr;
+					}
+					mArenas.push_back(arena);
+					size_t classSize = size_t(32) << sizeClass;
+					for (size_t offset = 0; offset + classSize <= mArenaSize; offset += classSize) {
+						freeList.push_back(arena + offset);
+					}
+				}
+				void* block = freeList.back();
+				freeList.pop_back();
+				return block;
+			}
+
+			uint32_t getCategory(const char* typeName) {
+				// PhysX names are string literals, so the pointer is a cheap key; getStats() merges equal strings
+				auto found = mCategoryIndices.find(typeName);
+				if (found != mCategoryIndices.end()) {
+					return found->second;
+				}
+				uint32_t index = static_cast<uint32_t>(mCategories.size());
+				mCategories.push_back({ typeName ? typeName : "unnamed", 0, 0, 0, 0 });
+				mCategoryIndices[typeName] = index;
+				return index;
+			}
+
+			std::mutex mMutex;
+			bool mPooling;
+			size_t mLiveBytes;
+			size_t mPeakBytes;
+			std::vector<Category> mCategories;
+			std::unordered_map<const char*, uint32_t> mCategoryIndices;
+			std::vector<void*> mFreeLists[mSizeClassCount];
+			std::vector<void*> mArenas;
+		};
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sitara {
+	namespace ecs {
+		/*
+		* Small work-stealing thread pool.  Every worker owns a job queue; it pops new work off the back of its own
+		* queue and steals from the front of the other queues when it runs dry.  Threads that wait on a parallelFor()
+		* run queued jobs themselves instead of blocking, so nested waits can't starve the pool.
+		*/
+		class JobPool {
+		public:
+			/*
+			* The engine-wide pool shared by PhysX (through JobPoolDispatcher) and the sitara systems.  It is created on
+			* first use; configureInstance() -- normally called from configureSystems() -- sets it up before that.
+			*/
+			static JobPool& getInstance();
+			static void configureInstance(uint32_t numWorkers, bool pinThreads);
+
+			// numWorkers = 0 uses one worker per core, minus one for the app's main thread
+			explicit JobPool(uint32_t numWorkers = 0, bool pinThreads = false);
+			~JobPool();
+
+			JobPool(JobPool const&) = delete;
+			JobPool& operator=(JobPool const&) = delete;
+
+			uint32_t getWorkerCount() const;
+			void submit(std::function<void()> job);
+
+			/*
+			* Splits [0, count) into chunks of at most grainSize and runs fn(begin, end) on each, returning once every
+			* chunk has finished.  Chunk boundaries only depend on count and grainSize, never on the number of threads.
+			*/
+			void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& fn);
+
+		private:
+			struct WorkerQueue {
+				std::mutex mMutex;
+				std::deque<std::function<void()>> mJobs;
+			};
+
+			void workerLoop(uint32_t index);
+			void pinWorker(uint32_t index);
+			bool tryRunJob(uint32_t preferredQueue);
+			bool popJob(uint32_t queueIndex, std::function<void()>& job);
+			bool stealJob(uint32_t thiefIndex, std::function<void()>& job);
+
+			std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+			std::vector<std::thread> mWorkers;
+			std::atomic<uint32_t> mNextQueue;
+			std::atomic<int64_t> mQueuedJobs;
+			std::mutex mWakeMutex;
+			std::condition_variable mWake;
+			std::atomic<bool> mStop;
+		};
+	}
+}
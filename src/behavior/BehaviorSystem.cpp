@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "behavior/BehaviorSystem.h"
 #include "behavior/Target.h"
 #include "behavior/NoiseField.h"
@@ -11,21 +12,13 @@
 
 using namespace sitara::ecs;
 
-void BehaviorSystem::update(entityx::EntityManager &entities, entityx::EventManager &events, entityx::TimeDelta dt) {
-	entityx::ComponentHandle<sitara::ecs::Target> staticTarget;
-
-	for (auto entity : entities.entities_with_components(staticTarget)) {
-		staticTarget->update();
-	}
-}
-
-void BehaviorSystem::seek(entityx::Entity& entity) {
-	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
-	entityx::ComponentHandle<sitara::ecs::Target> target = entity.component<sitara::ecs::Target>();
-
-	if (body.valid() && target.valid()) {
-		ci::vec3 position = body->getPosition();
-		ci::vec3 targetOffset = target->getTargetPosition() - position;
+namespace {
+	/*
+	* The steering math is shared between the per-entity calls and the batched pass in update(),
+	* so both paths always produce the same forces.
+	*/
+	ci::vec3 seekForce(const ci::vec3& position, const ci::vec3& velocity, const ci::vec3& targetPosition, float weight) {
+		ci::vec3 targetOffset = targetPosition - position;
 		ci::vec3 norm;
 		if (glm::length(targetOffset) == 0) {
 			norm = ci::vec3(0);
@@ -34,20 +27,12 @@ void BehaviorSystem::seek(entityx::Entity& entity) {
 			norm = glm::normalize(targetOffset);
 		}
 
-		ci::vec3 desiredVelocity = target->mWeight * norm;
-		ci::vec3 currentVelocity = body->getVelocity();
-		ci::vec3 desiredAcceleration = desiredVelocity - currentVelocity;
-		body->applyForce(desiredAcceleration);
+		ci::vec3 desiredVelocity = weight * norm;
+		return desiredVelocity - velocity;
 	}
-}
-
-void BehaviorSystem::flee(entityx::Entity& entity, ci::vec3 nullDirection) {
-	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
-	entityx::ComponentHandle<sitara::ecs::Target> target = entity.component<sitara::ecs::Target>();
 
-	if (body.valid() && target.valid()) {
-		ci::vec3 position = body->getPosition();
-		ci::vec3 targetOffset = position - target->getTargetPosition();
+	ci::vec3 fleeForce(const ci::vec3& position, const ci::vec3& velocity, const ci::vec3& targetPosition, float weight, const ci::vec3& nullDirection) {
+		ci::vec3 targetOffset = position - targetPosition;
 		ci::vec3 norm;
 		if (glm::length(targetOffset) < 10) {
 			norm = nullDirection;
@@ -55,55 +40,38 @@ void BehaviorSystem::flee(entityx::Entity& entity, ci::vec3 nullDirection) {
 		else {
 			norm = glm::normalize(targetOffset);
 		}
-		ci::vec3 desiredVelocity = target->mWeight * norm;
-		ci::vec3 currentVelocity = body->getVelocity();
-		ci::vec3 desiredAcceleration = desiredVelocity - currentVelocity;
-		body->applyForce(desiredAcceleration);
+		ci::vec3 desiredVelocity = weight * norm;
+		return desiredVelocity - velocity;
 	}
-}
-
-void BehaviorSystem::arrive(entityx::Entity& entity) {
-	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
-	entityx::ComponentHandle<sitara::ecs::Target> target = entity.component<sitara::ecs::Target>();
 
-	if (body.valid() && target.valid()) {
-		ci::vec3 position = body->getPosition();			
-		ci::vec3 t_p = target->getTargetPosition();
-		ci::vec3 targetOffset = t_p - position;
+	ci::vec3 arriveForce(const ci::vec3& position, const ci::vec3& velocity, const ci::vec3& targetPosition, float weight, float slowingDistance) {
+		ci::vec3 targetOffset = targetPosition - position;
 		float distance = glm::length(targetOffset);
 		ci::vec3 norm;
-		if(glm::length(targetOffset) < 10) {
+		if (distance < 10) {
 			norm = ci::vec3(0);
 		}
 		else {
 			norm = glm::normalize(targetOffset);
 		}
-		
+
 		ci::vec3 desiredVelocity;
-		if (distance < target->mSlowingDistance) {
+		if (distance < slowingDistance) {
 			// slow down
-			desiredVelocity = target->mWeight * (distance / target->mSlowingDistance) * norm;
+			desiredVelocity = weight * (distance / slowingDistance) * norm;
 		}
 		else {
 			// regular seek behavior
-			desiredVelocity = target->mWeight * norm;
+			desiredVelocity = weight * norm;
 		}
-		ci::vec3 currentVelocity = body->getVelocity();
-		ci::vec3 desiredAcceleration = desiredVelocity - currentVelocity;
-		body->applyForce(desiredAcceleration);
+		return desiredVelocity - velocity;
 	}
-}
 
-void BehaviorSystem::wander(entityx::Entity& entity) {
-	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
-	entityx::ComponentHandle<sitara::ecs::NoiseField> noise = entity.component<sitara::ecs::NoiseField>();
-
-	if (body.valid() && noise.valid()) {
-		ci::vec3 position = body->getPosition();
+	ci::vec3 wanderForce(const ci::vec3& position, const ci::vec4& multipliers, const ci::vec4& offsets, float weight, double time) {
 		ci::vec3 direction = ci::vec3(
-			Simplex::noise(ci::vec2(position.x*noise->mMultipliers.x + noise->mOffsets.x, noise->mMultipliers.w * ci::app::getElapsedSeconds() + noise->mOffsets.w)),
-			Simplex::noise(ci::vec2(position.y*noise->mMultipliers.y + noise->mOffsets.y, noise->mMultipliers.w * ci::app::getElapsedSeconds() + noise->mOffsets.w)),
-			Simplex::noise(ci::vec2(position.z*noise->mMultipliers.z + noise->mOffsets.z, noise->mMultipliers.w * ci::app::getElapsedSeconds() + noise->mOffsets.w))
+			Simplex::noise(ci::vec2(position.x*multipliers.x + offsets.x, multipliers.w * time + offsets.w)),
+			Simplex::noise(ci::vec2(position.y*multipliers.y + offsets.y, multipliers.w * time + offsets.w)),
+			Simplex::noise(ci::vec2(position.z*multipliers.z + offsets.z, multipliers.w * time + offsets.w))
 		);
 		ci::vec3 norm;
 		if (glm::length(direction) == 0) {
@@ -113,73 +81,326 @@ void BehaviorSystem::wander(entityx::Entity& entity) {
 			norm = glm::normalize(direction);
 		}
 
-		ci::vec3 desiredAcceleration = noise->mWeight * norm;
-		body->applyForce(desiredAcceleration);
+		return weight * norm;
+	}
+}
+
+BehaviorSystem::BehaviorSystem() {
+	mSteeringBehaviors = Behavior::NONE;
+	mFleeDirection = ci::vec3(0, 0, 1);
+	mSteeringTime = 0.0;
+	mJobPool = nullptr;
+	mMultithreaded = true;
+	mNeighborIndexFrame = 0;
+	mNeighborIndexBuilt = false;
+}
+
+void BehaviorSystem::update(entityx::EntityManager &entities, entityx::EventManager &events, entityx::TimeDelta dt) {
+	entityx::ComponentHandle<sitara::ecs::Target> staticTarget;
+
+	for (auto entity : entities.entities_with_components(staticTarget)) {
+		staticTarget->update();
+	}
+
+	// with no batched behaviors the index is left to separate() / cohere() / align(), which build it on first use
+	if (mSteeringBehaviors == Behavior::NONE) {
+		return;
+	}
+
+	buildNeighborIndex(entities);
+
+	mSteeringTime = ci::app::getElapsedSeconds();
+
+	/*
+	* Every body only reads the snapshot and writes its own slot in mForces, so chunks can run on any thread.
+	* Each body sums its neighbors in the same order regardless of which thread handles it, so the forces
+	* are identical whatever the thread count.
+	*/
+	if (mMultithreaded && mBodies.size() > mSteeringGrainSize) {
+		JobPool& pool = mJobPool ? *mJobPool : JobPool::getInstance();
+		pool.parallelFor(mBodies.size(), mSteeringGrainSize, [this](size_t begin, size_t end) {
+			computeSteeringForces(begin, end);
+		});
+	}
+	else {
+		computeSteeringForces(0, mBodies.size());
+	}
+
+	// write every steered body's summed force back to PhysX in one pass
+	for (size_t i = 0; i < mBodies.size(); i++) {
+		if (mAgents[i].mBehaviors & mSteeringBehaviors) {
+			mBodies[i]->applyForce(mForces[i]);
+		}
+	}
+}
+
+void BehaviorSystem::setSteeringBehaviors(uint32_t behaviors) {
+	mSteeringBehaviors = behaviors;
+}
+
+uint32_t BehaviorSystem::getSteeringBehaviors() {
+	return mSteeringBehaviors;
+}
+
+void BehaviorSystem::setFleeDirection(const ci::vec3& nullDirection) {
+	mFleeDirection = nullDirection;
+}
+
+void BehaviorSystem::setJobPool(JobPool* pool) {
+	mJobPool = pool;
+}
+
+void BehaviorSystem::enableMultithreading(const bool enable) {
+	mMultithreaded = enable;
+}
+
+void BehaviorSystem::buildNeighborIndex(entityx::EntityManager& entities) {
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body;
+	entityx::ComponentHandle<sitara::ecs::Separation> separation;
+	entityx::ComponentHandle<sitara::ecs::Cohesion> cohesion;
+	entityx::ComponentHandle<sitara::ecs::Alignment> alignment;
+
+	// cells are sized to the largest zone so a neighbor search never has to look further than one cell over
+	float cellSize = 0.0f;
+	bool plainNeighbors = false;
+	for (auto entity : entities.entities_with_components(separation)) {
+		cellSize = std::max(cellSize, separation->mZoneRadius);
+		plainNeighbors = true;
+	}
+	for (auto entity : entities.entities_with_components(cohesion)) {
+		cellSize = std::max(cellSize, cohesion->mZoneRadius);
+	}
+	for (auto entity : entities.entities_with_components(alignment)) {
+		cellSize = std::max(cellSize, alignment->mZoneRadius);
+		plainNeighbors = true;
+	}
+
+	mPositions.clear();
+	mVelocities.clear();
+	mIds.clear();
+	mAgents.clear();
+	mBodies.clear();
+
+	for (auto entity : entities.entities_with_components(body)) {
+		SteeringAgent agent = {};
+
+		auto target = entity.component<sitara::ecs::Target>();
+		if (target.valid()) {
+			agent.mBehaviors |= Behavior::SEEK | Behavior::FLEE | Behavior::ARRIVE;
+			agent.mTargetPosition = target->getTargetPosition();
+			agent.mTargetWeight = target->mWeight;
+			agent.mSlowingDistance = target->mSlowingDistance;
+		}
+
+		auto noise = entity.component<sitara::ecs::NoiseField>();
+		if (noise.valid()) {
+			agent.mBehaviors |= Behavior::WANDER;
+			agent.mNoiseMultipliers = noise->mMultipliers;
+			agent.mNoiseOffsets = noise->mOffsets;
+			agent.mNoiseWeight = noise->mWeight;
+		}
+
+		separation = entity.component<sitara::ecs::Separation>();
+		if (separation.valid()) {
+			agent.mBehaviors |= Behavior::SEPARATE;
+			agent.mSeparationRadius = separation->mZoneRadius;
+			agent.mSeparationWeight = separation->mWeight;
+		}
+
+		cohesion = entity.component<sitara::ecs::Cohesion>();
+		if (cohesion.valid()) {
+			agent.mBehaviors |= Behavior::COHERE;
+			agent.mCohesionRadius = cohesion->mZoneRadius;
+			agent.mCohesionWeight = cohesion->mWeight;
+		}
+
+		alignment = entity.component<sitara::ecs::Alignment>();
+		if (alignment.valid()) {
+			agent.mBehaviors |= Behavior::ALIGN;
+			agent.mAlignmentRadius = alignment->mZoneRadius;
+			agent.mAlignmentWeight = alignment->mWeight;
+		}
+
+		/*
+		* Bodies without a steering component only matter as neighbors, and only to separation and alignment,
+		* which push away from / match every body in their zone.  Cohesion only counts other cohering bodies.
+		*/
+		if (agent.mBehaviors == Behavior::NONE && !plainNeighbors) {
+			continue;
+		}
+
+		mPositions.push_back(body->getPosition());
+		mVelocities.push_back(body->getVelocity());
+		mIds.push_back(entity.id());
+		mAgents.push_back(agent);
+		mBodies.push_back(body);
 	}
 
+	mForces.assign(mBodies.size(), ci::vec3(0));
+	mNeighborIndex.build(mPositions, cellSize);
+	mNeighborIndexFrame = ci::app::getElapsedFrames();
+	mNeighborIndexBuilt = true;
+}
+
+void BehaviorSystem::refreshNeighborIndex(entityx::EntityManager& entities) {
+	// bodies only move when physics steps, so one snapshot per frame serves every separate/cohere/align call
+	if (!mNeighborIndexBuilt || mNeighborIndexFrame != ci::app::getElapsedFrames()) {
+		buildNeighborIndex(entities);
+	}
+}
+
+void BehaviorSystem::computeSteeringForces(size_t begin, size_t end) {
+	for (size_t i = begin; i < end; i++) {
+		const SteeringAgent& agent = mAgents[i];
+		uint32_t behaviors = agent.mBehaviors & mSteeringBehaviors;
+		const ci::vec3& position = mPositions[i];
+		const ci::vec3& velocity = mVelocities[i];
+		ci::vec3 force(0);
+
+		if (behaviors & Behavior::SEEK) {
+			force += seekForce(position, velocity, agent.mTargetPosition, agent.mTargetWeight);
+		}
+		if (behaviors & Behavior::FLEE) {
+			force += fleeForce(position, velocity, agent.mTargetPosition, agent.mTargetWeight, mFleeDirection);
+		}
+		if (behaviors & Behavior::ARRIVE) {
+			force += arriveForce(position, velocity, agent.mTargetPosition, agent.mTargetWeight, agent.mSlowingDistance);
+		}
+		if (behaviors & Behavior::WANDER) {
+			force += wanderForce(position, agent.mNoiseMultipliers, agent.mNoiseOffsets, agent.mNoiseWeight, mSteeringTime);
+		}
+		if (behaviors & Behavior::SEPARATE) {
+			force += separationForce(mIds[i], position, agent.mSeparationRadius, agent.mSeparationWeight);
+		}
+		if (behaviors & Behavior::COHERE) {
+			force += cohesionForce(mIds[i], position, velocity, agent.mCohesionRadius, agent.mCohesionWeight);
+		}
+		if (behaviors & Behavior::ALIGN) {
+			force += alignmentForce(mIds[i], position, velocity, agent.mAlignmentRadius, agent.mAlignmentWeight);
+		}
+
+		mForces[i] = force;
+	}
+}
+
+ci::vec3 BehaviorSystem::separationForce(entityx::Entity::Id id, const ci::vec3& position, float zoneRadius, float weight) const {
+	ci::vec3 desiredAcceleration(0);
+	mNeighborIndex.query(position, zoneRadius, [&](uint32_t i) {
+		if (mIds[i] != id) {
+			ci::vec3 offset = position - mPositions[i];
+			float distance = glm::length(offset);
+			if (distance < zoneRadius) {
+				desiredAcceleration += weight * (10.0f / (distance)) * glm::normalize(offset);
+			}
+		}
+	});
+	return desiredAcceleration;
+}
+
+ci::vec3 BehaviorSystem::cohesionForce(entityx::Entity::Id id, const ci::vec3& position, const ci::vec3& velocity, float zoneRadius, float weight) const {
+	ci::vec3 target(0,0,0);
+	int entityCount = 0;
+	mNeighborIndex.query(position, zoneRadius, [&](uint32_t i) {
+		if ((mAgents[i].mBehaviors & Behavior::COHERE) && mIds[i] != id) {
+			float distance = glm::length(position - mPositions[i]);
+			if (distance < zoneRadius) {
+				target += mPositions[i];
+				entityCount++;
+			}
+		}
+	});
+	if (entityCount == 0) {
+		target = ci::vec3(0, 0, 0);
+	}
+	else {
+		target /= float(entityCount);
+	}
+	ci::vec3 normalizedVelocity = ci::vec3(0);
+	ci::vec3 targetOffset = target - position;
+	if (glm::length(targetOffset) < 10) {
+		normalizedVelocity = ci::vec3(0);
+	}
+	else {
+		normalizedVelocity = glm::normalize(targetOffset);
+	}
+	ci::vec3 desiredVelocity = weight * normalizedVelocity;
+	return desiredVelocity - velocity;
+}
+
+ci::vec3 BehaviorSystem::alignmentForce(entityx::Entity::Id id, const ci::vec3& position, const ci::vec3& velocity, float zoneRadius, float weight) const {
+	ci::vec3 groupVelocity(0,0,0);
+	mNeighborIndex.query(position, zoneRadius, [&](uint32_t i) {
+		if (mIds[i] != id) {
+			float distance = glm::length(position - mPositions[i]);
+			if (distance < zoneRadius) {
+				groupVelocity += mVelocities[i];
+			}
+		}
+	});
+	ci::vec3 normalizedVelocity = ci::vec3(0);
+	if (glm::length(groupVelocity) == 0) {
+		normalizedVelocity = ci::vec3(0);
+	}
+	else {
+		normalizedVelocity = glm::normalize(groupVelocity);
+	}
+	ci::vec3 desiredVelocity = weight * normalizedVelocity;
+	return desiredVelocity - velocity;
+}
+
+void BehaviorSystem::seek(entityx::Entity& entity) {
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
+	entityx::ComponentHandle<sitara::ecs::Target> target = entity.component<sitara::ecs::Target>();
+
+	if (body.valid() && target.valid()) {
+		body->applyForce(seekForce(body->getPosition(), body->getVelocity(), target->getTargetPosition(), target->mWeight));
+	}
+}
+
+void BehaviorSystem::flee(entityx::Entity& entity, ci::vec3 nullDirection) {
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
+	entityx::ComponentHandle<sitara::ecs::Target> target = entity.component<sitara::ecs::Target>();
+
+	if (body.valid() && target.valid()) {
+		body->applyForce(fleeForce(body->getPosition(), body->getVelocity(), target->getTargetPosition(), target->mWeight, nullDirection));
+	}
+}
+
+void BehaviorSystem::arrive(entityx::Entity& entity) {
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
+	entityx::ComponentHandle<sitara::ecs::Target> target = entity.component<sitara::ecs::Target>();
+
+	if (body.valid() && target.valid()) {
+		body->applyForce(arriveForce(body->getPosition(), body->getVelocity(), target->getTargetPosition(), target->mWeight, target->mSlowingDistance));
+	}
+}
+
+void BehaviorSystem::wander(entityx::Entity& entity) {
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
+	entityx::ComponentHandle<sitara::ecs::NoiseField> noise = entity.component<sitara::ecs::NoiseField>();
+
+	if (body.valid() && noise.valid()) {
+		body->applyForce(wanderForce(body->getPosition(), noise->mMultipliers, noise->mOffsets, noise->mWeight, ci::app::getElapsedSeconds()));
+	}
 }
 
 void BehaviorSystem::separate(entityx::Entity& entity, entityx::EntityManager& entities) {
 	entityx::ComponentHandle<sitara::ecs::DynamicBody> b1 = entity.component<sitara::ecs::DynamicBody>();
 	entityx::ComponentHandle<sitara::ecs::Separation> separation = entity.component<sitara::ecs::Separation>();
 
-	// this is implemented in an inefficient way; I should come back and find an elegant resolution with iterators
 	if(b1.valid() && separation.valid()) {
-		entityx::ComponentHandle<sitara::ecs::DynamicBody> b2;
-		for (auto e2 : entities.entities_with_components(b2)) {
-			if (entity != e2) {
-				ci::vec3 p1 = b1->getPosition();
-				ci::vec3 p2 = b2->getPosition();
-				ci::vec3 offset = p1 - p2;
-				float distance = glm::length(offset);
-				if (distance < separation->mZoneRadius) {
-					ci::vec3 desiredAcceleration = separation->mWeight * (10.0f / (distance)) * glm::normalize(offset); 
-					b1->applyForce(desiredAcceleration);
-				}
-			}
-		}
+		refreshNeighborIndex(entities);
+		b1->applyForce(separationForce(entity.id(), b1->getPosition(), separation->mZoneRadius, separation->mWeight));
 	}
 }
 
 void BehaviorSystem::cohere(entityx::Entity& entity, entityx::EntityManager& entities) {
 	entityx::ComponentHandle<sitara::ecs::DynamicBody> b1 = entity.component<sitara::ecs::DynamicBody>();
 	entityx::ComponentHandle<sitara::ecs::Cohesion> cohesion = entity.component<sitara::ecs::Cohesion>();
-	// this is implemented in an inefficient way; I should come back and find an elegant resolution with iterators
+
 	if (b1.valid() && cohesion.valid()) {
-		entityx::ComponentHandle<sitara::ecs::DynamicBody> b2;
-		entityx::ComponentHandle<sitara::ecs::Cohesion> c2;
-		ci::vec3 target(0,0,0);
-		int entityCount = 0;
-		for (auto e2 : entities.entities_with_components(b2, c2)) {
-			if (entity != e2) {
-				ci::vec3 p1 = b1->getPosition();
-				ci::vec3 p2 = b2->getPosition();
-				ci::vec3 offset = p1 - p2;
-				float distance = glm::length(offset);
-				if (distance < cohesion->mZoneRadius) {
-					target += b2->getPosition();
-					entityCount++;
-				}
-			}
-		}
-		if (entityCount == 0) {
-			target = ci::vec3(0, 0, 0);
-		}
-		else {
-			target /= float(entityCount);
-		}
-		ci::vec3 position = b1->getPosition();
-		ci::vec3 normalizedVelocity = ci::vec3(0);
-		ci::vec3 targetOffset = target - position;
-		if (glm::length(targetOffset) < 10) {
-			normalizedVelocity = ci::vec3(0);
-		}
-		else {
-			normalizedVelocity = glm::normalize(targetOffset);
-		}
-		ci::vec3 desiredVelocity = cohesion->mWeight * normalizedVelocity;
-		ci::vec3 desiredAcceleration = desiredVelocity - b1->getVelocity();
-		b1->applyForce(desiredAcceleration);
+		refreshNeighborIndex(entities);
+		b1->applyForce(cohesionForce(entity.id(), b1->getPosition(), b1->getVelocity(), cohesion->mZoneRadius, cohesion->mWeight));
 	}
 }
 
@@ -187,30 +408,8 @@ void BehaviorSystem::align(entityx::Entity& entity, entityx::EntityManager& enti
 	entityx::ComponentHandle<sitara::ecs::DynamicBody> b1 = entity.component<sitara::ecs::DynamicBody>();
 	entityx::ComponentHandle<sitara::ecs::Alignment> alignment = entity.component<sitara::ecs::Alignment>();
 
-	// this is implemented in an inefficient way; I should come back and find an elegant resolution with iterators
 	if (b1.valid() && alignment.valid()) {
-		entityx::ComponentHandle<sitara::ecs::DynamicBody> b2;
-		ci::vec3 groupVelocity(0,0,0);
-		for (auto e2 : entities.entities_with_components(b2)) {
-			if (entity != e2) {
-				ci::vec3 p1 = b1->getPosition();
-				ci::vec3 p2 = b2->getPosition();
-				ci::vec3 offset = p1 - p2;
-				float distance = glm::length(offset);
-				if (distance < alignment->mZoneRadius) {
-					groupVelocity += b2->getVelocity();
-				}
-			}
-		}
-		ci::vec3 normalizedVelocity = ci::vec3(0);
-		if (glm::length(groupVelocity) == 0) {
-			normalizedVelocity = ci::vec3(0);
-		}
-		else {
-			normalizedVelocity = glm::normalize(groupVelocity);
-		}
-		ci::vec3 desiredVelocity = alignment->mWeight * normalizedVelocity;
-		ci::vec3 desiredAcceleration = desiredVelocity - b1->getVelocity();
-		b1->applyForce(desiredAcceleration);
+		refreshNeighborIndex(entities);
+		b1->applyForce(alignmentForce(entity.id(), b1->getPosition(), b1->getVelocity(), alignment->mZoneRadius, alignment->mWeight));
 	}
-}
+}
\ No newline at end of file
@@ -1,76 +1,508 @@
+#include <algorithm>
+#include <cmath>
 #include "physics/ParticleSystem.h"
 #include "transform/Transform.h"
+#include "cinder/Rand.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SITARA_PARTICLES_SSE
+#include <emmintrin.h>
+#endif
 
 using namespace sitara::ecs;
 
-ParticleSystem::ParticleSystem() {
+namespace {
+	const float kDragCoefficient = -0.5f;
+	const float kMaximumForce = 1000.0f;
+
+	/*
+	* Attractor force on particle i: (a - p) * (mass / |a - p|^2) * strength.
+	* Note that the offset is deliberately left un-normalized, matching Attractor::apply().
+	*/
+	void attractRange(const float* px, const float* py, const float* pz, const float* mass,
+					  float* fx, float* fy, float* fz, size_t begin, size_t end,
+					  const ci::vec3& position, const ci::vec3& strength) {
+		size_t i = begin;
+#ifdef SITARA_PARTICLES_SSE
+		const __m128 ax = _mm_set1_ps(position.x);
+		const __m128 ay = _mm_set1_ps(position.y);
+		const __m128 az = _mm_set1_ps(position.z);
+		const __m128 sx = _mm_set1_ps(strength.x);
+		const __m128 sy = _mm_set1_ps(strength.y);
+		const __m128 sz = _mm_set1_ps(strength.z);
+
+		for (; i + 4 <= end; i += 4) {
+			__m128 dx = _mm_sub_ps(ax, _mm_loadu_ps(px + i));
+			__m128 dy = _mm_sub_ps(ay, _mm_loadu_ps(py + i));
+			__m128 dz = _mm_sub_ps(az, _mm_loadu_ps(pz + i));
+			__m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			__m128 forceConstant = _mm_div_ps(_mm_loadu_ps(mass + i), distanceSq);
+
+			_mm_storeu_ps(fx + i, _mm_add_ps(_mm_loadu_ps(fx + i), _mm_mul_ps(dx, _mm_mul_ps(forceConstant, sx))));
+			_mm_storeu_ps(fy + i, _mm_add_ps(_mm_loadu_ps(fy + i), _mm_mul_ps(dy, _mm_mul_ps(forceConstant, sy))));
+			_mm_storeu_ps(fz + i, _mm_add_ps(_mm_loadu_ps(fz + i), _mm_mul_ps(dz, _mm_mul_ps(forceConstant, sz))));
+		}
+#endif
+		for (; i < end; i++) {
+			float dx = position.x - px[i];
+			float dy = position.y - py[i];
+			float dz = position.z - pz[i];
+			float forceConstant = mass[i] / (dx * dx + dy * dy + dz * dz);
+			fx[i] += dx * forceConstant * strength.x;
+			fy[i] += dy * forceConstant * strength.y;
+			fz[i] += dz * forceConstant * strength.z;
+		}
+	}
+
+	/*
+	* Adds drag, clamps the total force to kMaximumForce and takes one step:
+	*   p += v * dt + a * dt^2 / 2
+	*   v += a * dt
+	* A zero force is left at zero rather than normalized, which used to turn resting particles into NaNs.
+	*/
+	void integrateRange(float* px, float* py, float* pz, float* vx, float* vy, float* vz,
+						float* fx, float* fy, float* fz, const float* mass, size_t begin, size_t end, float dt) {
+		const float tt = 0.5f * dt * dt;
+		size_t i = begin;
+#ifdef SITARA_PARTICLES_SSE
+		const __m128 drag = _mm_set1_ps(kDragCoefficient);
+		const __m128 maxForce = _mm_set1_ps(kMaximumForce);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 dtv = _mm_set1_ps(dt);
+		const __m128 ttv = _mm_set1_ps(tt);
+
+		for (; i + 4 <= end; i += 4) {
+			__m128 velX = _mm_loadu_ps(vx + i);
+			__m128 velY = _mm_loadu_ps(vy + i);
+			__m128 velZ = _mm_loadu_ps(vz + i);
+
+			__m128 forceX = _mm_add_ps(_mm_loadu_ps(fx + i), _mm_mul_ps(velX, drag));
+			__m128 forceY = _mm_add_ps(_mm_loadu_ps(fy + i), _mm_mul_ps(velY, drag));
+			__m128 forceZ = _mm_add_ps(_mm_loadu_ps(fz + i), _mm_mul_ps(velZ, drag));
+
+			__m128 magnitude = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(forceX, forceX), _mm_mul_ps(forceY, forceY)), _mm_mul_ps(forceZ, forceZ)));
+			__m128 clamped = _mm_cmpgt_ps(magnitude, maxForce);
+			__m128 scale = _mm_or_ps(_mm_and_ps(clamped, _mm_div_ps(maxForce, magnitude)), _mm_andnot_ps(clamped, one));
+			forceX = _mm_mul_ps(forceX, scale);
+			forceY = _mm_mul_ps(forceY, scale);
+			forceZ = _mm_mul_ps(forceZ, scale);
+
+			__m128 inverseMass = _mm_div_ps(one, _mm_loadu_ps(mass + i));
+			__m128 accX = _mm_mul_ps(forceX, inverseMass);
+			__m128 accY = _mm_mul_ps(forceY, inverseMass);
+			__m128 accZ = _mm_mul_ps(forceZ, inverseMass);
+
+			_mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_add_ps(_mm_mul_ps(velX, dtv), _mm_mul_ps(accX, ttv))));
+			_mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_add_ps(_mm_mul_ps(velY, dtv), _mm_mul_ps(accY, ttv))));
+			_mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_add_ps(_mm_mul_ps(velZ, dtv), _mm_mul_ps(accZ, ttv))));
+
+			_mm_storeu_ps(vx + i, _mm_add_ps(velX, _mm_mul_ps(accX, dtv)));
+			_mm_storeu_ps(vy + i, _mm_add_ps(velY, _mm_mul_ps(accY, dtv)));
+			_mm_storeu_ps(vz + i, _mm_add_ps(velZ, _mm_mul_ps(accZ, dtv)));
+
+			_mm_storeu_ps(fx + i, forceX);
+			_mm_storeu_ps(fy + i, forceY);
+			_mm_storeu_ps(fz + i, forceZ);
+		}
+#endif
+		for (; i < end; i++) {
+			float forceX = fx[i] + vx[i] * kDragCoefficient;
+			float forceY = fy[i] + vy[i] * kDragCoefficient;
+			float forceZ = fz[i] + vz[i] * kDragCoefficient;
+
+			float magnitude = std::sqrt(forceX * forceX + forceY * forceY + forceZ * forceZ);
+			float scale = (magnitude > 0.0f) ? sitara::ecs::physics::clampParticleForce(magnitude, kMaximumForce) / magnitude : 1.0f;
+			forceX *= scale;
+			forceY *= scale;
+			forceZ *= scale;
+
+			float inverseMass = 1.0f / mass[i];
+			float accX = forceX * inverseMass;
+			float accY = forceY * inverseMass;
+			float accZ = forceZ * inverseMass;
+
+			px[i] += vx[i] * dt + accX * tt;
+			py[i] += vy[i] * dt + accY * tt;
+			pz[i] += vz[i] * dt + accZ * tt;
+
+			vx[i] += accX * dt;
+			vy[i] += accY * dt;
+			vz[i] += accZ * dt;
+
+			fx[i] = forceX;
+			fy[i] = forceY;
+			fz[i] = forceZ;
+		}
+	}
+}
+
+void ParticleSystem::ParticleBuffer::add(Particle* particle, Transform* transform) {
+	particle->mSlot = static_cast<int32_t>(mParticles.size());
+	mPositionX.push_back(particle->mPosition.x);
+	mPositionY.push_back(particle->mPosition.y);
+	mPositionZ.push_back(particle->mPosition.z);
+	mVelocityX.push_back(particle->mVelocity.x);
+	mVelocityY.push_back(particle->mVelocity.y);
+	mVelocityZ.push_back(particle->mVelocity.z);
+	mForceX.push_back(0.0f);
+	mForceY.push_back(0.0f);
+	mForceZ.push_back(0.0f);
+	mMass.push_back(particle->mMass);
+	mAge.push_back(particle->mAge);
+	mLifetime.push_back(particle->mLifetime);
+	mParticles.push_back(particle);
+	mTransforms.push_back(transform);
+}
+
+void ParticleSystem::ParticleBuffer::remove(size_t slot) {
+	// swap-remove: the last particle moves into the freed slot
+	size_t last = mParticles.size() - 1;
+	mParticles[slot]->mSlot = -1;
+	if (slot != last) {
+		for (std::vector<float>* values : { &mPositionX, &mPositionY, &mPositionZ, &mVelocityX, &mVelocityY, &mVelocityZ,
+											&mForceX, &mForceY, &mForceZ, &mMass, &mAge, &mLifetime }) {
+			(*values)[slot] = (*values)[last];
+		}
+		mParticles[slot] = mParticles[last];
+		mTransforms[slot] = mTransforms[last];
+		mParticles[slot]->mSlot = static_cast<int32_t>(slot);
+	}
+
+	for (std::vector<float>* values : { &mPositionX, &mPositionY, &mPositionZ, &mVelocityX, &mVelocityY, &mVelocityZ,
+										&mForceX, &mForceY, &mForceZ, &mMass, &mAge, &mLifetime }) {
+		values->pop_back();
+	}
+	mParticles.pop_back();
+	mTransforms.pop_back();
+}
 
+void ParticleSystem::ParticleBuffer::clearForces() {
+	std::fill(mForceX.begin(), mForceX.end(), 0.0f);
+	std::fill(mForceY.begin(), mForceY.end(), 0.0f);
+	std::fill(mForceZ.begin(), mForceZ.end(), 0.0f);
+}
+
+size_t ParticleSystem::ParticleBuffer::size() const {
+	return mParticles.size();
+}
+
+ParticleSystem::ParticleSystem() {
+	mApproximateAttractors = false;
+	mApproximationThreshold = 32;
 }
 
 ParticleSystem::~ParticleSystem() {
+	// detach the particles we know about so they stop queueing into a dead list
+	for (auto particle : mBuffer.mParticles) {
+		particle->mChangedParticles = nullptr;
+	}
+	for (auto particle : mChangedParticles) {
+		particle->mChangedParticles = nullptr;
+	}
 }
 
 void ParticleSystem::configure(entityx::EntityManager& entities, entityx::EventManager& events) {
+	events.subscribe<entityx::ComponentRemovedEvent<Emitter>>(*this);
+	events.subscribe<entityx::ComponentAddedEvent<Particle>>(*this);
+	events.subscribe<entityx::ComponentRemovedEvent<Particle>>(*this);
+	events.subscribe<entityx::ComponentAddedEvent<Transform>>(*this);
+	events.subscribe<entityx::ComponentRemovedEvent<Transform>>(*this);
 }
 
 void ParticleSystem::update(entityx::EntityManager& entities, entityx::EventManager& events, entityx::TimeDelta dt) {
+	updateEmitters(entities, static_cast<float>(dt));
+	syncChangedParticles();
+	applyAttractors(entities);
+	applySprings(entities);
+	ageParticles(static_cast<float>(dt));
+	integrateParticles(static_cast<float>(dt));
+	writeParticles();
+
 	entityx::ComponentHandle<sitara::ecs::Attractor> attractor;
-	entityx::ComponentHandle<sitara::ecs::Particle> particle;
-	entityx::ComponentHandle<sitara::ecs::Spring> spring;
 	entityx::ComponentHandle<sitara::ecs::Transform> transform;
+	for (auto entity : entities.entities_with_components(attractor, transform)) {
+		transform->mPosition = attractor->getPosition();
+	}
+}
 
-	for (auto entity : entities.entities_with_components(particle)) {
-		particle->clearForces();
+void ParticleSystem::receive(const entityx::ComponentRemovedEvent<Emitter>& event) {
+	// the pool lives and dies with its emitter
+	entityx::ComponentHandle<sitara::ecs::Emitter> emitter = event.component;
+	for (auto& entity : emitter->mPool) {
+		if (entity.valid()) {
+			entity.destroy();
+		}
+	}
+	emitter->mPool.clear();
+	emitter->mPoolParticles.clear();
+	emitter->mSlotInUse.clear();
+	emitter->mFreeSlots.clear();
+}
 
-		ci::vec3 v = particle->getVelocity();
-		// add drag
-		v *= -0.5f;
-		particle->addForce(v);
+void ParticleSystem::receive(const entityx::ComponentAddedEvent<Particle>& event) {
+	entityx::ComponentHandle<sitara::ecs::Particle> handle = event.component;
+	Particle* particle = handle.get();
+	particle->mEntity = event.entity;
+	particle->mSlot = -1;
+	particle->mChanged = false;
+	particle->mChangedParticles = &mChangedParticles;
+	// joins the buffer on the next sync, once a Dependency has had the chance to add its Transform
+	particle->markChanged();
+}
+
+void ParticleSystem::receive(const entityx::ComponentRemovedEvent<Particle>& event) {
+	entityx::ComponentHandle<sitara::ecs::Particle> handle = event.component;
+	Particle* particle = handle.get();
+	if (particle->mChanged) {
+		mChangedParticles.erase(std::find(mChangedParticles.begin(), mChangedParticles.end(), particle));
+		particle->mChanged = false;
 	}
+	if (particle->mSlot >= 0) {
+		mBuffer.remove(particle->mSlot);
+	}
+	particle->mChangedParticles = nullptr;
+}
 
-	for (auto entity : entities.entities_with_components(attractor)) {
-		if (attractor->IsOn()) {
-			for (auto entity : entities.entities_with_components(particle)) {
-				attractor->apply(particle);
+void ParticleSystem::receive(const entityx::ComponentAddedEvent<Transform>& event) {
+	entityx::Entity entity = event.entity;
+	entityx::ComponentHandle<sitara::ecs::Transform> transform = event.component;
+	auto particle = entity.component<sitara::ecs::Particle>();
+	if (particle.valid() && particle->mSlot >= 0) {
+		mBuffer.mTransforms[particle->mSlot] = transform.get();
+	}
+}
+
+void ParticleSystem::receive(const entityx::ComponentRemovedEvent<Transform>& event) {
+	entityx::Entity entity = event.entity;
+	auto particle = entity.component<sitara::ecs::Particle>();
+	if (particle.valid() && particle->mSlot >= 0) {
+		mBuffer.mTransforms[particle->mSlot] = nullptr;
+	}
+}
+
+double ParticleSystem::getElapsedSimulationTime() {
+	return 0.0;
+}
+
+void ParticleSystem::enableAttractorApproximation(bool enable, float theta, size_t minimumAttractors) {
+	mApproximateAttractors = enable;
+	mAttractorTree.setTheta(theta);
+	mApproximationThreshold = minimumAttractors;
+}
+
+bool ParticleSystem::isAttractorApproximationEnabled() {
+	return mApproximateAttractors;
+}
+
+void ParticleSystem::updateEmitters(entityx::EntityManager& entities, float dt) {
+	entityx::ComponentHandle<sitara::ecs::Emitter> emitter;
+	entityx::ComponentHandle<sitara::ecs::Transform> transform;
+
+	for (auto entity : entities.entities_with_components(emitter, transform)) {
+		if (emitter->mPool.size() != emitter->mCapacity) {
+			buildEmitterPool(entities, emitter);
+		}
+
+		for (uint32_t slot = 0; slot < emitter->mPool.size(); slot++) {
+			// pool entities can be destroyed, or lose their Particle, behind the emitter's back; rebuild those slots
+			bool rebuilt = false;
+			if (!emitter->mPool[slot].valid()) {
+				emitter->mPool[slot] = createPoolEntity(entities, emitter);
+				rebuilt = true;
+			}
+			if (!emitter->mPoolParticles[slot].valid()) {
+				emitter->mPoolParticles[slot] = emitter->mPool[slot].component<sitara::ecs::Particle>();
+				if (!emitter->mPoolParticles[slot].valid()) {
+					emitter->mPoolParticles[slot] = emitter->mPool[slot].assign<sitara::ecs::Particle>(emitter->mMass);
+					emitter->mPoolParticles[slot]->kill();
+				}
+				rebuilt = true;
 			}
+
+			// hand back the slots of particles that expired (or were killed) since the last update
+			if (emitter->mSlotInUse[slot] && (rebuilt || !emitter->mPoolParticles[slot]->isAlive())) {
+				emitter->mSlotInUse[slot] = false;
+				emitter->mFreeSlots.push_back(slot);
+			}
+		}
+
+		size_t spawnCount = emitter->mPendingBurst;
+		emitter->mPendingBurst = 0;
+		if (emitter->mIsOn) {
+			emitter->mSpawnAccumulator += emitter->mRate * dt;
+			size_t continuous = static_cast<size_t>(emitter->mSpawnAccumulator);
+			emitter->mSpawnAccumulator -= static_cast<float>(continuous);
+			spawnCount += continuous;
+		}
+
+		ci::vec3 origin = ci::vec3(transform->getWorldTransform()[3]);
+		while (spawnCount > 0 && !emitter->mFreeSlots.empty()) {
+			uint32_t slot = emitter->mFreeSlots.back();
+			emitter->mFreeSlots.pop_back();
+			emitter->mSlotInUse[slot] = true;
+
+			ci::vec3 velocity = emitter->mVelocity;
+			if (emitter->mVelocitySpread > 0.0f) {
+				velocity += emitter->mVelocitySpread * ci::randVec3();
+			}
+
+			entityx::ComponentHandle<sitara::ecs::Particle>& particle = emitter->mPoolParticles[slot];
+			particle->reset(origin, velocity);
+			particle->setMass(emitter->mMass);
+			particle->setLifetime(emitter->mLifetime);
+
+			auto particleTransform = emitter->mPool[slot].component<sitara::ecs::Transform>();
+			if (particleTransform.valid()) {
+				particleTransform->mPosition = origin;
+				particleTransform->show();
+			}
+			spawnCount--;
 		}
 	}
+}
 
-	for (auto entity : entities.entities_with_components(spring)) {
-		spring->apply();
+void ParticleSystem::buildEmitterPool(entityx::EntityManager& entities, entityx::ComponentHandle<Emitter> emitter) {
+	while (emitter->mPool.size() < emitter->mCapacity) {
+		entityx::Entity entity = createPoolEntity(entities, emitter);
+		emitter->mFreeSlots.push_back(static_cast<uint32_t>(emitter->mPool.size()));
+		emitter->mPool.push_back(entity);
+		emitter->mPoolParticles.push_back(entity.component<sitara::ecs::Particle>());
+		emitter->mSlotInUse.push_back(false);
+	}
+}
+
+entityx::Entity ParticleSystem::createPoolEntity(entityx::EntityManager& entities, entityx::ComponentHandle<Emitter> emitter) {
+	entityx::Entity entity = entities.create();
+	auto particle = entity.assign<sitara::ecs::Particle>(emitter->mMass);
+	particle->kill();
+
+	auto transform = entity.component<sitara::ecs::Transform>();
+	if (!transform.valid()) {
+		transform = entity.assign<sitara::ecs::Transform>();
+	}
+	transform->hide();
+
+	if (emitter->mCreateFn) {
+		emitter->mCreateFn(entity);
+	}
+	return entity;
+}
+
+void ParticleSystem::syncChangedParticles() {
+	for (auto particle : mChangedParticles) {
+		particle->mChanged = false;
+
+		if (!particle->mIsAlive) {
+			if (particle->mSlot >= 0) {
+				mBuffer.remove(particle->mSlot);
+			}
+			particle->clearForces();
+			continue;
+		}
+
+		if (particle->mSlot < 0) {
+			auto transform = particle->mEntity.component<sitara::ecs::Transform>();
+			mBuffer.add(particle, transform.valid() ? transform.get() : nullptr);
+		}
+
+		size_t i = static_cast<size_t>(particle->mSlot);
+		mBuffer.mPositionX[i] = particle->mPosition.x;
+		mBuffer.mPositionY[i] = particle->mPosition.y;
+		mBuffer.mPositionZ[i] = particle->mPosition.z;
+		mBuffer.mVelocityX[i] = particle->mVelocity.x;
+		mBuffer.mVelocityY[i] = particle->mVelocity.y;
+		mBuffer.mVelocityZ[i] = particle->mVelocity.z;
+		mBuffer.mForceX[i] += particle->mForces.x;
+		mBuffer.mForceY[i] += particle->mForces.y;
+		mBuffer.mForceZ[i] += particle->mForces.z;
+		mBuffer.mMass[i] = particle->mMass;
+		mBuffer.mAge[i] = particle->mAge;
+		mBuffer.mLifetime[i] = particle->mLifetime;
+		particle->clearForces();
 	}
+	mChangedParticles.clear();
+}
 
-	float tt = 0.5f*dt*dt;
+void ParticleSystem::applyAttractors(entityx::EntityManager& entities) {
+	entityx::ComponentHandle<sitara::ecs::Attractor> attractor;
 
-	for (auto entity : entities.entities_with_components(particle)) {
-		ci::vec3 force = particle->getForces();
-		float magnitude = glm::length(force);
-		magnitude = physics::clampParticleForce(magnitude, 1000.0f);
-		ci::vec3 direction = glm::normalize(force);
+	mAttractorPositions.clear();
+	mAttractorStrengths.clear();
+	for (auto entity : entities.entities_with_components(attractor)) {
+		if (attractor->IsOn()) {
+			mAttractorPositions.push_back(attractor->getPosition());
+			mAttractorStrengths.push_back(attractor->getStrength());
+		}
+	}
 
-		ci::vec3 correctedForce = magnitude * direction;
-		ci::vec3 velocity = particle->getVelocity();
-		ci::vec3 position = particle->getPosition();
-		ci::vec3 acceleration = correctedForce * 1.0f / particle->getMass();
+	if (!mApproximateAttractors || mAttractorPositions.size() < mApproximationThreshold) {
+		for (size_t a = 0; a < mAttractorPositions.size(); a++) {
+			attractRange(mBuffer.mPositionX.data(), mBuffer.mPositionY.data(), mBuffer.mPositionZ.data(), mBuffer.mMass.data(),
+						 mBuffer.mForceX.data(), mBuffer.mForceY.data(), mBuffer.mForceZ.data(), 0, mBuffer.size(),
+						 mAttractorPositions[a], mAttractorStrengths[a]);
+		}
+		return;
+	}
 
-		position += velocity * float(dt);
-		position += acceleration * tt;
+	mAttractorTree.build(mAttractorPositions, mAttractorStrengths);
+	for (size_t i = 0; i < mBuffer.size(); i++) {
+		ci::vec3 force = mAttractorTree.evaluate(ci::vec3(mBuffer.mPositionX[i], mBuffer.mPositionY[i], mBuffer.mPositionZ[i]), mBuffer.mMass[i]);
+		mBuffer.mForceX[i] += force.x;
+		mBuffer.mForceY[i] += force.y;
+		mBuffer.mForceZ[i] += force.z;
+	}
+}
 
-		velocity += acceleration * float(dt);
+void ParticleSystem::applySprings(entityx::EntityManager& entities) {
+	entityx::ComponentHandle<sitara::ecs::Spring> spring;
 
-		particle->setVelocity(velocity);
-		particle->setPosition(position);
+	for (auto entity : entities.entities_with_components(spring)) {
+		spring->apply();
 	}
 
-	for (auto entity : entities.entities_with_components(particle, transform)) {
-		transform->mPosition = particle->getPosition();
+	// springs push into the Particle components, which queues them for the buffer
+	syncChangedParticles();
+}
+
+void ParticleSystem::ageParticles(float dt) {
+	for (size_t i = 0; i < mBuffer.size(); i++) {
+		mBuffer.mAge[i] += dt;
+		if (mBuffer.mLifetime[i] > 0.0f && mBuffer.mAge[i] >= mBuffer.mLifetime[i]) {
+			mExpiredSlots.push_back(i);
+		}
 	}
 
-	for (auto entity : entities.entities_with_components(attractor, transform)) {
-		transform->mPosition = attractor->getPosition();
+	// highest slot first, so a swap-remove never moves a slot that is still waiting to expire
+	for (auto slot = mExpiredSlots.rbegin(); slot != mExpiredSlots.rend(); ++slot) {
+		// retired in place; an emitter will pick the slot up again on its next update
+		Particle* particle = mBuffer.mParticles[*slot];
+		particle->mIsAlive = false;
+		particle->mAge = mBuffer.mAge[*slot];
+		if (mBuffer.mTransforms[*slot]) {
+			mBuffer.mTransforms[*slot]->hide();
+		}
+		mBuffer.remove(*slot);
 	}
+	mExpiredSlots.clear();
 }
 
-double ParticleSystem::getElapsedSimulationTime() {
-	return 0.0;
-}
\ No newline at end of file
+void ParticleSystem::integrateParticles(float dt) {
+	integrateRange(mBuffer.mPositionX.data(), mBuffer.mPositionY.data(), mBuffer.mPositionZ.data(),
+				   mBuffer.mVelocityX.data(), mBuffer.mVelocityY.data(), mBuffer.mVelocityZ.data(),
+				   mBuffer.mForceX.data(), mBuffer.mForceY.data(), mBuffer.mForceZ.data(),
+				   mBuffer.mMass.data(), 0, mBuffer.size(), dt);
+}
+
+void ParticleSystem::writeParticles() {
+	for (size_t i = 0; i < mBuffer.size(); i++) {
+		Particle* particle = mBuffer.mParticles[i];
+		particle->mPosition = ci::vec3(mBuffer.mPositionX[i], mBuffer.mPositionY[i], mBuffer.mPositionZ[i]);
+		particle->mVelocity = ci::vec3(mBuffer.mVelocityX[i], mBuffer.mVelocityY[i], mBuffer.mVelocityZ[i]);
+		particle->mAge = mBuffer.mAge[i];
+
+		if (mBuffer.mTransforms[i]) {
+			mBuffer.mTransforms[i]->mPosition = particle->mPosition;
+		}
+	}
+	mBuffer.clearForces();
+}
@@ -1,31 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include "physics/PhysicsSystem.h"
 #include "transform/Transform.h"
+#include "cinder/app/App.h"
 
 using namespace sitara::ecs;
 
+namespace {
+	/*
+	* PxDefaultSimulationFilterShader, plus layer filtering and touch reports.  word0 holds a shape's layer bit and
+	* word1 the layers it collides with; shapes without a layer (word0 == 0) collide with everything.  Shapes with
+	* REPORT_CONTACTS in word2 get touch reports.
+	*/
+	physx::PxFilterFlags reportingFilterShader(physx::PxFilterObjectAttributes attributes0, physx::PxFilterData filterData0,
+											   physx::PxFilterObjectAttributes attributes1, physx::PxFilterData filterData1,
+											   physx::PxPairFlags& pairFlags, const void* constantBlock, physx::PxU32 constantBlockSize) {
+		if (filterData0.word0 && filterData1.word0 && !((filterData0.word0 & filterData1.word1) && (filterData1.word0 & filterData0.word1))) {
+			// killed pairs stay dropped until one of the shapes' filter data changes
+			return physx::PxFilterFlag::eKILL;
+		}
+
+		if (physx::PxFilterObjectIsTrigger(attributes0) || physx::PxFilterObjectIsTrigger(attributes1)) {
+			pairFlags = physx::PxPairFlag::eTRIGGER_DEFAULT;
+			return physx::PxFilterFlag::eDEFAULT;
+		}
+
+		pairFlags = physx::PxPairFlag::eCONTACT_DEFAULT;
+		if ((filterData0.word2 | filterData1.word2) & sitara::ecs::physics::REPORT_CONTACTS) {
+			pairFlags |= physx::PxPairFlag::eNOTIFY_TOUCH_FOUND | physx::PxPairFlag::eNOTIFY_TOUCH_LOST | physx::PxPairFlag::eNOTIFY_CONTACT_POINTS;
+		}
+		return physx::PxFilterFlag::eDEFAULT;
+	}
+
+	// FNV-1a; cooked meshes are cached under the hash of the data they were cooked from
+	uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	uint64_t hashMesh(const ci::TriMesh& mesh, const char* kind) {
+		uint32_t version = PX_PHYSICS_VERSION;
+		uint64_t hash = hashBytes(kind, std::strlen(kind));
+		hash = hashBytes(&version, sizeof(version), hash);
+		hash = hashBytes(mesh.getPositions<3>(), mesh.getNumVertices() * sizeof(ci::vec3), hash);
+		hash = hashBytes(mesh.getIndices().data(), mesh.getIndices().size() * sizeof(uint32_t), hash);
+		return hash;
+	}
+
+	std::string cacheFileName(const char* kind, uint64_t hash) {
+		std::stringstream name;
+		name << kind << "_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+		return name.str();
+	}
+}
+
 PhysicsSystem::PhysicsSystem() {
 	mFoundation = nullptr;
+	mReportAllocationNames = false;
 	mPhysics = nullptr;
 	mDispatcher = nullptr;
 	mCudaContext = nullptr;
 	mScene = nullptr;
 	mPvd = nullptr;
-	mNumberOfThreads = 8;
+	mPvdEnabled = false;
+	mPvdHost = "127.0.0.1";
+	mPvdPort = 5425;
+	mPvdTimeout = 10;
+	mPvdFlags = physx::PxPvdInstrumentationFlag::eALL;
+	mSimulationStatsEnabled = false;
+	mCooking = nullptr;
+	mCookingCacheDirectorySet = false;
+	mSerializationRegistry = nullptr;
+	mBroadPhaseType = physx::PxBroadPhaseType::eLAST;	// keep PhysX's default
+	mWorldSubdivisions = 4;
+	mHasWorldBounds = false;
+	mOutOfBoundsFn = nullptr;
+	mBroadPhaseProfiling = false;
+	mIncrementalOverlaps = false;
+	mOverlapSceneChanged = true;
+	mActiveBoundsWidth = 0.0f;
+	mChangedBoundsWidth = 0.0f;
+	mLayerMasks.fill(~physx::PxU32(0));
+	mLayerMasksChanged = false;
+	mStaticPromotion = false;
+	mPromotionThreshold = 8;
+	mBodyPooling = false;
+	mMaxParkedBodies = 1024;
+	mNumberOfThreads = 0;
 	mMaterialCount = -1;
 	mSimulationTime = 0.0f;
+	mFixedTimeStep = 0.0f;
+	mMaxSubSteps = 4;
+	mAccumulator = 0.0f;
+	mInterpolationAlpha = 1.0f;
+	mAsyncSimulation = false;
+	mSimulationPending = false;
+	mJobPool = nullptr;
+	mMultithreadedQueries = true;
 	mGpuEnabled = false;
 }
 
 
 PhysicsSystem::~PhysicsSystem() {
-	if (mScene) {
-		mScene->release();
-		mScene = nullptr;
+	fetchPendingResults();
+	for (auto& sceneState : mScenes) {
+		for (auto query : sceneState->mBatchQueries) {
+			query->release();
+		}
+		sceneState->mBatchQueries.clear();
+	}
+	for (auto aggregate : mAggregates) {
+		aggregate->release();
+	}
+	mAggregates.clear();
+	for (auto& pool : mBodyPools) {
+		for (auto actor : pool.mParked) {
+			actor->release();
+		}
+	}
+	mBodyPools.clear();
+	for (auto& shape : mSharedShapes) {
+		shape.second->release();
+	}
+	mSharedShapes.clear();
+	for (auto& mesh : mConvexMeshes) {
+		mesh.second->release();
 	}
+	mConvexMeshes.clear();
+	for (auto& mesh : mTriangleMeshes) {
+		mesh.second->release();
+	}
+	mTriangleMeshes.clear();
+	if (mCooking) {
+		mCooking->release();
+		mCooking = nullptr;
+	}
+	if (mSerializationRegistry) {
+		mSerializationRegistry->release();
+		mSerializationRegistry = nullptr;
+	}
+	for (auto& sceneState : mScenes) {
+		sceneState->mScene->release();
+	}
+	mScenes.clear();
+	mScene = nullptr;
 	if (mDispatcher) {
 		mDispatcher->release();
 		mDispatcher = nullptr;
 	}
+	mJobDispatcher.reset();
 	if (mCudaContext) {
 		mCudaContext->release();
 		mCudaContext = nullptr;
@@ -34,6 +166,8 @@ PhysicsSystem::~PhysicsSystem() {
 		mPhysics->release();
 		mPhysics = nullptr;
 	}
+	// deserialized objects live inside these blocks, so they go only after PhysX has released everything
+	mSnapshotMemory.clear();
 	if (mPvd) {
 		physx::PxPvdTransport* transport = mPvd->getTransport();
 		mPvd->release();
@@ -51,41 +185,122 @@ PhysicsSystem::~PhysicsSystem() {
 
 void PhysicsSystem::configure(entityx::EntityManager& entities, entityx::EventManager& events) {
 	mFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, mAllocator, mErrorCallback);
-	mDispatcher = physx::PxDefaultCpuDispatcherCreate(mNumberOfThreads);
+	mFoundation->setReportAllocationNames(mReportAllocationNames);
+	if (mNumberOfThreads > 0) {
+		mDispatcher = physx::PxDefaultCpuDispatcherCreate(mNumberOfThreads);
+	}
+	else {
+		mJobDispatcher.reset(new JobPoolDispatcher(mJobPool ? *mJobPool : JobPool::getInstance()));
+	}
 
-	mPvd = PxCreatePvd(*mFoundation);
-	physx::PxPvdTransport* transport = physx::PxDefaultPvdSocketTransportCreate("127.0.0.1", 5425, 10);
-	mPvd->connect(*transport, physx::PxPvdInstrumentationFlag::eALL);
+	if (mPvdEnabled) {
+		mPvd = PxCreatePvd(*mFoundation);
+		physx::PxPvdTransport* transport = nullptr;
+		if (!mPvdFile.empty()) {
+			transport = physx::PxDefaultPvdFileTransportCreate(mPvdFile.string().c_str());
+		}
+		else {
+			transport = physx::PxDefaultPvdSocketTransportCreate(mPvdHost.c_str(), mPvdPort, mPvdTimeout);
+		}
+		if (!transport || !mPvd->connect(*transport, mPvdFlags)) {
+			std::cout << "sitara::ecs::PhysicsSystem -- couldn't open the PhysX Visual Debugger transport; continuing without capture." << std::endl;
+			// without mPvd PhysX skips allocation tracking and instrumentation altogether
+			mPvd->release();
+			mPvd = nullptr;
+			if (transport) {
+				transport->release();
+			}
+		}
+	}
 	
-	mPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *mFoundation, physx::PxTolerancesScale(), true, mPvd);
+	mPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *mFoundation, physx::PxTolerancesScale(), mPvd != nullptr, mPvd);
 	PxInitExtensions(*mPhysics, mPvd);
 
-	physx::PxSceneDesc sceneDesc(mPhysics->getTolerancesScale());
-	sceneDesc.cpuDispatcher = mDispatcher;
-	sceneDesc.filterShader = physx::PxDefaultSimulationFilterShader;
-	//sceneDesc.flags = physx::PxSceneFlag::eREQUIRE_RW_LOCK;
+	mCooking = PxCreateCooking(PX_PHYSICS_VERSION, *mFoundation, physx::PxCookingParams(mPhysics->getTolerancesScale()));
+	if (!mCookingCacheDirectorySet) {
+		// an explicitly empty directory means in-memory only, so only an unset one gets the default
+		mCookingCacheDirectory = ci::app::getAppPath() / "cooked";
+	}
+	mSerializationRegistry = physx::PxSerialization::createSerializationRegistry(*mPhysics);
 
 	if (mGpuEnabled) {
 		physx::PxCudaContextManagerDesc cudaDesc;
 		mCudaContext = PxCreateCudaContextManager(*mFoundation, cudaDesc);
+	}
+
+	addScene();
+	mScene = mScenes[0]->mScene;
+
+	events.subscribe<entityx::ComponentAddedEvent<DynamicBody>>(*this);
+	events.subscribe<entityx::ComponentRemovedEvent<DynamicBody>>(*this);
+	events.subscribe<entityx::ComponentAddedEvent<StaticBody>>(*this);
+	events.subscribe<entityx::ComponentRemovedEvent<StaticBody>>(*this);
+	events.subscribe<entityx::ComponentAddedEvent<LogicalLayer>>(*this);
+	events.subscribe<entityx::ComponentAddedEvent<PhysicsScene>>(*this);
+}
+
+void PhysicsSystem::addScene() {
+	// heap allocated so the callback pointers handed to PhysX stay put as mScenes grows
+	std::unique_ptr<SceneState> sceneState(new SceneState());
+	sceneState->mSimulationStats = SimulationStats();
+	sceneState->mLastSimulationStats = SimulationStats();
+	sceneState->mBroadPhaseStats = BroadPhaseStats();
+
+	physx::PxSceneDesc sceneDesc(mPhysics->getTolerancesScale());
+	if (mDispatcher) {
+		sceneDesc.cpuDispatcher = mDispatcher;
+	}
+	else {
+		sceneDesc.cpuDispatcher = mJobDispatcher.get();
+	}
+	sceneDesc.filterShader = reportingFilterShader;
+	sceneDesc.simulationEventCallback = &sceneState->mSimulationEvents;
+	sceneDesc.broadPhaseCallback = &sceneState->mBroadPhaseEvents;
+	if (mBroadPhaseType != physx::PxBroadPhaseType::eLAST) {
+		sceneDesc.broadPhaseType = mBroadPhaseType;
+	}
+	sceneDesc.flags |= physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS;
+	//sceneDesc.flags = physx::PxSceneFlag::eREQUIRE_RW_LOCK;
+
+	if (mCudaContext) {
 		sceneDesc.cudaContextManager = mCudaContext;
 		sceneDesc.flags |= physx::PxSceneFlag::eENABLE_GPU_DYNAMICS;
 		sceneDesc.broadPhaseType = physx::PxBroadPhaseType::eGPU;
 	}
 
-	mScene = mPhysics->createScene(sceneDesc);
+	physx::PxScene* scene = mPhysics->createScene(sceneDesc);
+	sceneState->mScene = scene;
+
+	BroadPhaseStats& broadPhaseStats = sceneState->mBroadPhaseStats;
+	broadPhaseStats.mType = scene->getBroadPhaseType();
+	broadPhaseStats.mRegions = 0;
+	if (mHasWorldBounds && broadPhaseStats.mType == physx::PxBroadPhaseType::eMBP) {
+		// MBP supports at most 256 regions, which is also the most a 16 x 16 grid can produce
+		physx::PxBounds3 regionBounds[256];
+		physx::PxU32 subdivisions = std::min(mWorldSubdivisions, 16u);
+		physx::PxBounds3 bounds(sitara::ecs::physics::to(mWorldBounds.getMin()), sitara::ecs::physics::to(mWorldBounds.getMax()));
+		physx::PxU32 regionCount = physx::PxBroadPhaseExt::createRegionsFromWorldBounds(regionBounds, bounds, subdivisions, 1);
+		for (physx::PxU32 i = 0; i < regionCount; i++) {
+			physx::PxBroadPhaseRegion region;
+			region.mBounds = regionBounds[i];
+			region.mUserData = nullptr;
+			scene->addBroadPhaseRegion(region);
+		}
+		broadPhaseStats.mRegions = regionCount;
+	}
+	else if (broadPhaseStats.mType == physx::PxBroadPhaseType::eMBP) {
+		std::cout << "sitara::ecs::PhysicsSystem -- MBP without world bounds has no regions; nothing will collide. Call setWorldBounds()." << std::endl;
+	}
+	sceneState->mLastBroadPhaseStats = broadPhaseStats;
 
-	physx::PxPvdSceneClient* pvdClient = mScene->getScenePvdClient();
-	if (pvdClient) {
+	physx::PxPvdSceneClient* pvdClient = scene->getScenePvdClient();
+	if (mPvd && pvdClient) {
 		pvdClient->setScenePvdFlag(physx::PxPvdSceneFlag::eTRANSMIT_CONSTRAINTS, true);
 		pvdClient->setScenePvdFlag(physx::PxPvdSceneFlag::eTRANSMIT_CONTACTS, true);
 		pvdClient->setScenePvdFlag(physx::PxPvdSceneFlag::eTRANSMIT_SCENEQUERIES, true);
 	}
 
-	events.subscribe<entityx::ComponentAddedEvent<DynamicBody>>(*this);
-	events.subscribe<entityx::ComponentRemovedEvent<DynamicBody>>(*this);
-	events.subscribe<entityx::ComponentAddedEvent<StaticBody>>(*this);
-	events.subscribe<entityx::ComponentRemovedEvent<StaticBody>>(*this);
+	mScenes.push_back(std::move(sceneState));
 }
 
 void PhysicsSystem::update(entityx::EntityManager& entities, entityx::EventManager& events, entityx::TimeDelta dt) {
@@ -94,212 +309,1697 @@ void PhysicsSystem::update(entityx::EntityManager& entities, entityx::EventManag
 	entityx::ComponentHandle<sitara::ecs::OverlapDetector> overlapDetector;
 	entityx::ComponentHandle<sitara::ecs::Transform> transform;
 		
-	// preprocessing callbacks
-	for (auto entity : entities.entities_with_components(body, transform)) {
-		for (auto callback : mPreUpdateFns) {
-			callback(body);
-		}
-	}
+	// finish the step started at the end of the previous update, if any
+	fetchPendingResults();
+	applyCollisionLayers(entities);
 
-	// run simulation
-	float timeStep = static_cast<float>(dt);
-	mSimulationTime += timeStep;
-	mScene->simulate(timeStep);
-	mScene->fetchResults(true);
-
-	// update transform component with new world transform from physx
-	for (auto entity : entities.entities_with_components(body, transform)) {
-		if (!body->isSleeping()) {
-			transform->mPosition = body->getPosition();
-			transform->mOrientation = body->getRotation();
-		}
+	if (!mAsyncSimulation) {
+		stepSimulation(entities, static_cast<float>(dt), false);
 	}
 
+	syncDynamicBodies(entities);
+	emitSimulationEvents(entities, events);
+	handleOutOfBounds(entities);
+
+	mPromotedStatics.clear();
 	for (auto entity : entities.entities_with_components(sBody, transform)) {
 		if (sBody->isDirty()) {
 			transform->mPosition = sBody->getPosition();
 			transform->mOrientation = sBody->getRotation();
 			sBody->setDirty(false);
+			invalidateOverlaps(sBody->mBody, entity.id());
+
+			sBody->mMovedUpdates++;
+			if (mStaticPromotion && sBody->mMovedUpdates >= mPromotionThreshold) {
+				mPromotedStatics.push_back(entity);
+			}
+		}
+		else {
+			sBody->mMovedUpdates = 0;
+		}
+	}
+	for (auto& entity : mPromotedStatics) {
+		promoteStaticBody(entity);
+	}
+
+	updateOverlapDetectors(entities);
+
+	// post processing
+	for (auto entity : entities.entities_with_components(body, transform)) {
+		for (auto callback : mPostUpdateFns) {
+			callback(body);
 		}
 	}
 
-	/*
-	* Iterate over proximity detector components and detect proximities
-	* Any PhysX Scene Queries should go here
-	*/
+	if (mAsyncSimulation) {
+		// kick off the next step; it runs on the PhysX workers while the app draws
+		stepSimulation(entities, static_cast<float>(dt), true);
+	}
+
+	// memory is shared by every scene, so each scene's stats carry the same totals
+	size_t liveBytes = mSimulationStatsEnabled ? mAllocator.getLiveBytes() : 0;
+	size_t peakBytes = mSimulationStatsEnabled ? mAllocator.getPeakBytes() : 0;
+	for (auto& sceneState : mScenes) {
+		SimulationStats& simulationStats = sceneState->mSimulationStats;
+		simulationStats.mLiveBytes = liveBytes;
+		simulationStats.mPeakBytes = peakBytes;
+		sceneState->mLastSimulationStats = simulationStats;
+		simulationStats.mSteps = 0;
+		simulationStats.mSimulateTime = 0.0;
+		simulationStats.mFetchTime = 0.0;
+		simulationStats.mBroadPhaseAdds = 0;
+		simulationStats.mBroadPhaseRemoves = 0;
+
+		BroadPhaseStats& broadPhaseStats = sceneState->mBroadPhaseStats;
+		sceneState->mLastBroadPhaseStats = broadPhaseStats;
+		broadPhaseStats.mSteps = 0;
+		broadPhaseStats.mCollisionTime = 0.0;
+		broadPhaseStats.mAdds = 0;
+		broadPhaseStats.mRemoves = 0;
+		broadPhaseStats.mOutOfBounds = 0;
+	}
+}
+
+void PhysicsSystem::updateOverlapDetectors(entityx::EntityManager& entities) {
+	entityx::ComponentHandle<sitara::ecs::OverlapDetector> overlapDetector;
+	entityx::ComponentHandle<sitara::ecs::Transform> transform;
+
+	if (mIncrementalOverlaps) {
+		gatherActiveBounds(entities);
+	}
+
+	mOverlapQueue.clear();
+	mIdleOverlapDetectors.clear();
 	for (auto entity : entities.entities_with_components(overlapDetector, transform)) {
 		overlapDetector->setTransform(sitara::ecs::physics::to(transform->mOrientation, transform->mPosition));
+		uint32_t sceneIndex = getSceneIndex(entity);
+		if (mIncrementalOverlaps && !mOverlapSceneChanged && !needsOverlapQuery(overlapDetector, sceneIndex)) {
+			mIdleOverlapDetectors.push_back(overlapDetector);
+		}
+		else {
+			mOverlapQueue.push_back(std::make_pair(sceneIndex, overlapDetector));
+		}
+	}
+	mOverlapSceneChanged = false;
+	mChangedBounds.clear();
+	mChangedIds.clear();
+
+	// a batch query belongs to one scene, so detectors are grouped by scene before they're split into batches
+	if (mScenes.size() > 1) {
+		std::stable_sort(mOverlapQueue.begin(), mOverlapQueue.end(), [](const std::pair<uint32_t, entityx::ComponentHandle<OverlapDetector>>& a,
+																		const std::pair<uint32_t, entityx::ComponentHandle<OverlapDetector>>& b) {
+			return a.first < b.first;
+		});
+	}
+	mOverlapDetectors.clear();
+	mOverlapDetectorScenes.clear();
+	for (auto& queued : mOverlapQueue) {
+		mOverlapDetectorScenes.push_back(queued.first);
+		mOverlapDetectors.push_back(queued.second);
+	}
+
+	for (auto& idleDetector : mIdleOverlapDetectors) {
+		// nothing that could change the result moved; every overlap carries on as "during"
+		idleDetector->reuseResults();
+		emitOverlapCallbacks(entities, idleDetector);
+	}
+
+	if (mOverlapDetectors.empty()) {
+		return;
+	}
+
+	/*
+	* All detectors share one hit arena.  Each detector gets a slice as large as the most hits it has needed so far,
+	* and its queries are issued through its scene's PxBatchQuery in groups of up to mOverlapBatchSize, one group per job.
+	*/
+	size_t count = mOverlapDetectors.size();
+	mOverlapHitOffsets.resize(count + 1);
+	mOverlapHitOffsets[0] = 0;
+	for (size_t i = 0; i < count; i++) {
+		mOverlapHitOffsets[i + 1] = mOverlapHitOffsets[i] + mOverlapDetectors[i]->mHitCapacity;
+	}
+	if (mOverlapHits.size() < mOverlapHitOffsets[count]) {
+		mOverlapHits.resize(mOverlapHitOffsets[count]);
+	}
+	mOverlapResults.resize(count);
 
-		size_t num = physx::PxSceneQueryExt::overlapMultiple(*mScene,
-			overlapDetector->getGeometry(),
-			overlapDetector->getTransform(),
-			overlapDetector->getWriteBuffer(),
-			overlapDetector->getBufferSize(),
-			overlapDetector->getFilter());
-
-		overlapDetector->resizeBuffer(num);
-
-		for (auto& hit : overlapDetector->getResults()) {
-			if (hit.actor != nullptr) {
-				auto previous = overlapDetector->getPreviousResults();
-				auto it = std::find_if(previous.begin(), previous.end(), [&](const physx::PxOverlapHit& h) { return hit.actor == h.actor; });
-				if (it != previous.end()) {
-					// in current collision + previous collision, still colliding
-					entityx::Entity e = entity;
-					entityx::Entity overlappingEntity = entities.get(entityx::Entity::Id((uint64_t)(hit.actor->userData)));
-					if (e.id().id() != overlappingEntity.id().id()) {
-						for (auto& fn : overlapDetector->mDuringEachOverlapFns) {
-							fn(e, overlappingEntity);
-						}
-					}
-				}
-				else {
-					// in current collision but not previous collision, started colliding
-					entityx::Entity e = entity;
-					entityx::Entity overlappingEntity = entities.get(entityx::Entity::Id((uint64_t)(hit.actor->userData)));
-					if (e.id().id() != overlappingEntity.id().id()) {
-						for (auto& fn : overlapDetector->mOnEnterEachOverlapFns) {
-							fn(e, overlappingEntity);
-						}
-					}
-				}
+	mOverlapBatches.clear();
+	size_t sceneBegin = 0;
+	while (sceneBegin < count) {
+		uint32_t sceneIndex = mOverlapDetectorScenes[sceneBegin];
+		size_t sceneEnd = sceneBegin;
+		while (sceneEnd < count && mOverlapDetectorScenes[sceneEnd] == sceneIndex) {
+			sceneEnd++;
+		}
+
+		SceneState& sceneState = *mScenes[sceneIndex];
+		size_t sceneBatch = 0;
+		for (size_t begin = sceneBegin; begin < sceneEnd; begin += mOverlapBatchSize, sceneBatch++) {
+			if (sceneState.mBatchQueries.size() <= sceneBatch) {
+				physx::PxBatchQueryDesc desc(0, 0, static_cast<physx::PxU32>(mOverlapBatchSize));
+				sceneState.mBatchQueries.push_back(sceneState.mScene->createBatchQuery(desc));
 			}
+			OverlapBatch batch;
+			batch.mBegin = begin;
+			batch.mEnd = std::min(begin + mOverlapBatchSize, sceneEnd);
+			batch.mQuery = sceneState.mBatchQueries[sceneBatch];
+			mOverlapBatches.push_back(batch);
 		}
+		sceneBegin = sceneEnd;
+	}
+	size_t batchCount = mOverlapBatches.size();
+
+	auto runBatches = [&](size_t beginBatch, size_t endBatch) {
+		for (size_t batch = beginBatch; batch < endBatch; batch++) {
+			size_t begin = mOverlapBatches[batch].mBegin;
+			size_t end = mOverlapBatches[batch].mEnd;
 
-		for (auto& hit : overlapDetector->getPreviousResults()) {
-			if (hit.actor != nullptr) {
-				auto results = overlapDetector->getResults();
-				auto it = std::find_if(results.begin(), results.end(), [&](const physx::PxOverlapHit& h) { return hit.actor == h.actor; });
-				if (it == results.end()) {
-					// in previous collision but NOT in current collision, ending collision
-					entityx::Entity e = entity;
-					entityx::Entity::Id overlappingEntityId = entityx::Entity::Id((uint64_t)(hit.actor->userData));
-					if (entities.valid(overlappingEntityId)) {
-						entityx::Entity overlappingEntity = entities.get(overlappingEntityId);
-						if (e.id().id() != overlappingEntity.id().id()) {
-							for (auto& fn : overlapDetector->mOnEndEachOverlapFns) {
-								fn(e, overlappingEntity);
-							}
-						}
-					}
-				}
+			physx::PxBatchQueryMemory memory(0, 0, static_cast<physx::PxU32>(end - begin));
+			memory.userOverlapResultBuffer = &mOverlapResults[begin];
+			memory.userOverlapTouchBuffer = &mOverlapHits[mOverlapHitOffsets[begin]];
+			memory.overlapTouchBufferSize = static_cast<physx::PxU32>(mOverlapHitOffsets[end] - mOverlapHitOffsets[begin]);
+
+			physx::PxBatchQuery* query = mOverlapBatches[batch].mQuery;
+			query->setUserMemory(memory);
+			for (size_t i = begin; i < end; i++) {
+				physx::PxQueryFilterData filter = mOverlapDetectors[i]->getFilter();
+				filter.flags |= physx::PxQueryFlag::eNO_BLOCK;
+				query->overlap(mOverlapDetectors[i]->getGeometry(), mOverlapDetectors[i]->getTransform(),
+							   static_cast<physx::PxU16>(mOverlapDetectors[i]->mHitCapacity), filter);
 			}
+			query->execute();
 		}
+	};
 
-		overlapDetector->saveResults();
+	if (mMultithreadedQueries && batchCount > 1) {
+		JobPool& pool = mJobPool ? *mJobPool : JobPool::getInstance();
+		pool.parallelFor(batchCount, 1, runBatches);
+	}
+	else {
+		runBatches(0, batchCount);
 	}
 
-	// post processing
-	for (auto entity : entities.entities_with_components(body, transform)) {
-		for (auto callback : mPostUpdateFns) {
-			callback(body);
+	for (size_t i = 0; i < count; i++) {
+		overlapDetector = mOverlapDetectors[i];
+		const physx::PxOverlapQueryResult& result = mOverlapResults[i];
+		uint32_t hitCount = result.getNbAnyHits();
+
+		if (hitCount < overlapDetector->mHitCapacity || overlapDetector->mHitCapacity >= OverlapDetector::mMaxHitCapacity) {
+			overlapDetector->setResults(result.touches, hitCount);
 		}
+		else {
+			// the slice filled up and may have dropped hits; grow it for next frame and redo this one query
+			do {
+				uint32_t maxCapacity = OverlapDetector::mMaxHitCapacity;
+				overlapDetector->mHitCapacity = std::min(overlapDetector->mHitCapacity * 2, maxCapacity);
+				mOverflowHits.resize(overlapDetector->mHitCapacity);
+				physx::PxI32 num = physx::PxSceneQueryExt::overlapMultiple(*mScenes[mOverlapDetectorScenes[i]]->mScene,
+					overlapDetector->getGeometry(),
+					overlapDetector->getTransform(),
+					mOverflowHits.data(),
+					overlapDetector->mHitCapacity,
+					overlapDetector->getFilter());
+				hitCount = (num < 0) ? overlapDetector->mHitCapacity : static_cast<uint32_t>(num);
+			} while (hitCount >= overlapDetector->mHitCapacity && overlapDetector->mHitCapacity < OverlapDetector::mMaxHitCapacity);
+			overlapDetector->setResults(mOverflowHits.data(), hitCount);
+		}
+
+		overlapDetector->mNeedsQuery = false;
+		overlapDetector->mQueryPose = overlapDetector->getTransform();
+		emitOverlapCallbacks(entities, overlapDetector);
 	}
 }
 
-void PhysicsSystem::receive(const entityx::ComponentAddedEvent<sitara::ecs::DynamicBody>& event) {
-	/*
-	Link the user application entityx::Entity::Id to the NVIDIA PhysX object using the userData pointer.
-	Note that this is NOT a pointer to the entity; it's the entity's literal id number.
-	use ->getUserData() to get the entity's ID and mEntities.get(id); to get the entity handle directly
-	*/
-	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = event.component;
-	body->mBody->userData = (void*)(event.entity.id().id());
+void PhysicsSystem::emitOverlapCallbacks(entityx::EntityManager& entities, entityx::ComponentHandle<sitara::ecs::OverlapDetector> overlapDetector) {
+	// both id lists are sorted, so one merge pass sorts every overlap into enter, during or end
+	entityx::Entity e = overlapDetector.entity();
+	const std::vector<entityx::Entity::Id>& current = overlapDetector->getResults();
+	const std::vector<entityx::Entity::Id>& previous = overlapDetector->getPreviousResults();
+	size_t c = 0;
+	size_t p = 0;
+	while (c < current.size() || p < previous.size()) {
+		entityx::Entity::Id id;
+		std::vector<std::function<void(entityx::Entity, entityx::Entity)> >* fns;
+		if (p == previous.size() || (c < current.size() && current[c] < previous[p])) {
+			// in current collision but not previous collision, started colliding
+			id = current[c++];
+			fns = &overlapDetector->mOnEnterEachOverlapFns;
+		}
+		else if (c == current.size() || previous[p] < current[c]) {
+			// in previous collision but NOT in current collision, ending collision
+			id = previous[p++];
+			fns = &overlapDetector->mOnEndEachOverlapFns;
+		}
+		else {
+			// in current collision + previous collision, still colliding
+			id = current[c++];
+			p++;
+			fns = &overlapDetector->mDuringEachOverlapFns;
+		}
+
+		if (id == e.id() || !entities.valid(id)) {
+			continue;
+		}
+		entityx::Entity overlappingEntity = entities.get(id);
+		for (auto& fn : *fns) {
+			fn(e, overlappingEntity);
+		}
+	}
+
+	overlapDetector->saveResults();
 }
 
-void PhysicsSystem::receive(const entityx::ComponentRemovedEvent<sitara::ecs::DynamicBody>& event) {
+bool PhysicsSystem::needsOverlapQuery(entityx::ComponentHandle<sitara::ecs::OverlapDetector> overlapDetector, uint32_t sceneIndex) {
+	if (overlapDetector->mNeedsQuery) {
+		return true;
+	}
+
+	const physx::PxTransform& pose = overlapDetector->getTransform();
+	if (!(pose.p == overlapDetector->mQueryPose.p) || !(pose.q == overlapDetector->mQueryPose.q)) {
+		return true;
+	}
+
+	// a body this detector can see moved into the zone during the step, or was added, removed or relayered there
+	physx::PxBounds3 bounds = physx::PxGeometryQuery::getWorldBounds(overlapDetector->getGeometry(), pose);
+	physx::PxScene* scene = mScenes[sceneIndex]->mScene;
+	const physx::PxQueryFilterData& filter = overlapDetector->getFilter();
+	if (intersectsTracked(mActiveBounds, mActiveBoundsWidth, bounds, scene, filter) ||
+		intersectsTracked(mChangedBounds, mChangedBoundsWidth, bounds, scene, filter)) {
+		return true;
+	}
+
+	// or one of the bodies it saw last time moved or changed, possibly out of it; both lists are sorted
+	const std::vector<entityx::Entity::Id>& results = overlapDetector->getPreviousResults();
+	size_t r = 0;
+	size_t a = 0;
+	while (r < results.size() && a < mActiveIds.size()) {
+		if (results[r] < mActiveIds[a]) {
+			r++;
+		}
+		else if (mActiveIds[a] < results[r]) {
+			a++;
+		}
+		else {
+			return true;
+		}
+	}
+	return false;
 }
 
-void PhysicsSystem::receive(const entityx::ComponentAddedEvent<sitara::ecs::StaticBody>& event) {
-	/*
-	Link the user application entityx::Entity::Id to the NVIDIA PhysX object using the userData pointer.
-	Note that this is NOT a pointer to the entity; it's the entity's literal id number.
-	use ->getUserData() to get the entity's ID and mEntities.get(id); to get the entity handle directly
-	*/
-	entityx::ComponentHandle<sitara::ecs::StaticBody> body = event.component;
-	body->mBody->userData = (void*)(event.entity.id().id());
+void PhysicsSystem::gatherActiveBounds(entityx::EntityManager& entities) {
+	// bodies added since the last update have their shapes by now
+	for (auto& id : mAddedOverlapBodies) {
+		if (!entities.valid(id)) {
+			continue;
+		}
+		entityx::Entity entity = entities.get(id);
+		if (entity.has_component<sitara::ecs::DynamicBody>()) {
+			invalidateOverlaps(entity.component<sitara::ecs::DynamicBody>()->mBody, id);
+		}
+		else if (entity.has_component<sitara::ecs::StaticBody>()) {
+			invalidateOverlaps(entity.component<sitara::ecs::StaticBody>()->mBody, id);
+		}
+	}
+	mAddedOverlapBodies.clear();
+	sortTrackedBounds(mChangedBounds, mChangedBoundsWidth);
+
+	// mActiveBodies holds what the last step moved; see syncDynamicBodies()
+	mActiveBounds.clear();
+	mActiveIds.clear();
+	for (auto& body : mActiveBodies) {
+		TrackedBounds tracked = getTrackedBounds(body->mBody);
+		if (!tracked.mBounds.isEmpty()) {
+			mActiveBounds.push_back(tracked);
+		}
+		mActiveIds.push_back(body.entity().id());
+	}
+	sortTrackedBounds(mActiveBounds, mActiveBoundsWidth);
+
+	mActiveIds.insert(mActiveIds.end(), mChangedIds.begin(), mChangedIds.end());
+	std::sort(mActiveIds.begin(), mActiveIds.end());
+	mActiveIds.erase(std::unique(mActiveIds.begin(), mActiveIds.end()), mActiveIds.end());
 }
 
-void PhysicsSystem::receive(const entityx::ComponentRemovedEvent<sitara::ecs::StaticBody>& event) {
+void PhysicsSystem::invalidateOverlaps(physx::PxRigidActor* actor, entityx::Entity::Id id, physx::PxU32 previousLayer) {
+	// with incremental overlaps off every detector queries anyway
+	if (!mIncrementalOverlaps || !actor) {
+		return;
+	}
+
+	TrackedBounds tracked = getTrackedBounds(actor);
+	if (!tracked.mBounds.isEmpty()) {
+		// a relayered body matters to detectors that could see it before as well as after
+		tracked.mLayer |= previousLayer;
+		mChangedBounds.push_back(tracked);
+	}
+	mChangedIds.push_back(id);
 }
 
-double PhysicsSystem::getElapsedSimulationTime() {
-	return mSimulationTime;
+PhysicsSystem::TrackedBounds PhysicsSystem::getTrackedBounds(physx::PxRigidActor* actor) {
+	TrackedBounds tracked;
+	tracked.mBounds = actor->getNbShapes() > 0 ? actor->getWorldBounds() : physx::PxBounds3::empty();
+	tracked.mLayer = 0;
+	tracked.mScene = actor->getScene();
+	tracked.mStatic = actor->getType() == physx::PxActorType::eRIGID_STATIC;
+
+	// refreshCollisionLayer() gives every shape of a body the same query data
+	physx::PxShape* shape = nullptr;
+	if (actor->getShapes(&shape, 1) == 1) {
+		tracked.mLayer = shape->getQueryFilterData().word0;
+	}
+	return tracked;
 }
 
-void PhysicsSystem::setGravity(const ci::vec3& gravity) {
-	if (mScene) {
-		mScene->setGravity(physx::PxVec3(gravity.x, gravity.y, gravity.z));
+void PhysicsSystem::sortTrackedBounds(std::vector<TrackedBounds>& tracked, float& maxWidth) {
+	std::sort(tracked.begin(), tracked.end(), [](const TrackedBounds& a, const TrackedBounds& b) {
+		return a.mBounds.minimum.x < b.mBounds.minimum.x;
+	});
+	maxWidth = 0.0f;
+	for (auto& entry : tracked) {
+		maxWidth = std::max(maxWidth, entry.mBounds.maximum.x - entry.mBounds.minimum.x);
 	}
-	else {
-		std::cout << "sitara::ecs::PhysicsSystem ERROR -- must configure() system before you can set gravity." << std::endl;
+}
+
+bool PhysicsSystem::intersectsTracked(const std::vector<TrackedBounds>& tracked, float maxWidth, const physx::PxBounds3& bounds,
+									  physx::PxScene* scene, const physx::PxQueryFilterData& filter) {
+	// sorted by minimum.x, so only entries starting at most maxWidth left of the bounds can reach them
+	auto first = std::lower_bound(tracked.begin(), tracked.end(), bounds.minimum.x - maxWidth, [](const TrackedBounds& entry, float x) {
+		return entry.mBounds.minimum.x < x;
+	});
+	bool anyLayer = filter.data.word0 == 0 && filter.data.word1 == 0 && filter.data.word2 == 0 && filter.data.word3 == 0;
+	for (auto entry = first; entry != tracked.end() && entry->mBounds.minimum.x <= bounds.maximum.x; ++entry) {
+		if (entry->mScene != scene || !entry->mBounds.intersects(bounds)) {
+			continue;
+		}
+		// the same tests the query itself applies: static/dynamic flags, then the LogicalLayer mask
+		if (!filter.flags.isSet(entry->mStatic ? physx::PxQueryFlag::eSTATIC : physx::PxQueryFlag::eDYNAMIC)) {
+			continue;
+		}
+		if (anyLayer || (filter.data.word0 & entry->mLayer) != 0) {
+			return true;
+		}
 	}
+	return false;
 }
 
-void PhysicsSystem::setNumberOfThreads(const uint32_t numThreads) {
-	if (!mScene) {
-		mNumberOfThreads = numThreads;
+void PhysicsSystem::stepSimulation(entityx::EntityManager& entities, float dt, bool async) {
+	if (mFixedTimeStep > 0.0f) {
+		mAccumulator += dt;
+
+		uint32_t stepCount = std::min(static_cast<uint32_t>(mAccumulator / mFixedTimeStep), mMaxSubSteps);
+		uint32_t steps = 0;
+		while (mAccumulator >= mFixedTimeStep && steps < mMaxSubSteps) {
+			// sleeping bodies were settled (previous == current) when they dropped out of the active list
+			gatherActiveBodies(entities);
+			for (auto& activeBody : mActiveBodies) {
+				activeBody->savePreviousPose();
+			}
+			runPreUpdateFns(entities);
+
+			mAccumulator -= mFixedTimeStep;
+			steps++;
+			driveKinematicBodies(stepCount >= steps ? stepCount - steps + 1 : 1);
+
+			// in async mode only the last step of the frame is left running
+			bool lastStep = mAccumulator < mFixedTimeStep || steps == mMaxSubSteps;
+			simulateStep(mFixedTimeStep, async && lastStep);
+		}
+
+		if (mAccumulator >= mFixedTimeStep) {
+			// fell behind by more than maxSubSteps; drop the backlog rather than spiral
+			mAccumulator = std::fmod(mAccumulator, mFixedTimeStep);
+		}
+		mInterpolationAlpha = mAccumulator / mFixedTimeStep;
 	}
 	else {
-		std::cout << "Number of threads must be set before running PhysicsSystem::configure(); using default number of threads : " << mNumberOfThreads << std::endl;
+		runPreUpdateFns(entities);
+		driveKinematicBodies(1);
+		simulateStep(dt, async);
 	}
 }
 
-void PhysicsSystem::enableGpu(const bool enable) {
-	if (!mScene) {
-		std::cout << "GPU features are currently only available for dynamic builds; until a future time these features are disabled." << std::endl;
-		mGpuEnabled = true;
+void PhysicsSystem::simulateStep(float dt, bool async) {
+	mSimulationTime += dt;
+
+	// start every scene before waiting on any, so independent scenes run side by side on the workers
+	for (auto& sceneState : mScenes) {
+		auto simulateStart = std::chrono::high_resolution_clock::now();
+
+		if (mBroadPhaseProfiling) {
+			// same step as simulate(), split so the collision phase can be timed on its own (this serializes scenes)
+			sceneState->mScene->collide(dt);
+			sceneState->mScene->fetchCollision(true);
+			sceneState->mBroadPhaseStats.mCollisionTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - simulateStart).count();
+			sceneState->mScene->advance();
+		}
+		else {
+			sceneState->mScene->simulate(dt);
+		}
+
+		if (mSimulationStatsEnabled) {
+			sceneState->mSimulationStats.mSimulateTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - simulateStart).count();
+		}
+	}
+
+	if (async) {
+		mSimulationPending = true;
 	}
 	else {
-		std::cout << "GPU must be enabled before running PhysicsSystem::configure(); using CPU dispatcher instead." << std::endl;
+		fetchStepResults();
 	}
 }
 
-physx::PxRigidStatic* PhysicsSystem::createStaticBody(const ci::vec3& position, const ci::quat& rotation) {
-	physx::PxTransform transform = sitara::ecs::physics::to(rotation, position);
-	physx::PxRigidStatic* body = mPhysics->createRigidStatic(transform);
-	mScene->addActor(*body);
-	return body;
+void PhysicsSystem::fetchStepResults() {
+	for (auto& sceneState : mScenes) {
+		fetchStepResults(*sceneState);
+	}
 }
 
-physx::PxRigidDynamic* PhysicsSystem::createDynamicBody(const ci::vec3& position, const ci::quat& rotation) {
-	physx::PxTransform transform = sitara::ecs::physics::to(rotation, position);
-	physx::PxRigidDynamic* body = mPhysics->createRigidDynamic(transform);
-	mScene->addActor(*body);
-	return body;
-}
+void PhysicsSystem::fetchStepResults(SceneState& sceneState) {
+	auto fetchStart = std::chrono::high_resolution_clock::now();
+	sceneState.mScene->fetchResults(true);
 
-physx::PxDistanceJoint* PhysicsSystem::createSpring(entityx::ComponentHandle<sitara::ecs::DynamicBody> body, ci::vec3 anchorPoint, float stiffness, float dampingConstant) {
-	auto staticAnchor = createStaticBody(anchorPoint, ci::quat(0, ci::vec3(0, 0, 1)));
+	// the actors are all alive right now; later they're only compared against, never dereferenced
+	sceneState.mActiveEntities.clear();
+	sceneState.mActiveActors.clear();
+	physx::PxU32 activeCount = 0;
+	physx::PxActor** activeActors = sceneState.mScene->getActiveActors(activeCount);
+	for (physx::PxU32 i = 0; i < activeCount; i++) {
+		if (physx::PxRigidDynamic* actor = activeActors[i]->is<physx::PxRigidDynamic>()) {
+			sceneState.mActiveEntities.push_back(entityx::Entity::Id((uint64_t)(actor->userData)));
+			sceneState.mActiveActors.push_back(actor);
+		}
+	}
 
-	auto springJoint = physx::PxDistanceJointCreate(*mPhysics,
-		body->mBody,
-		physx::PxTransform(physx::PxIdentity),
-		staticAnchor,
-		physx::PxTransform(physx::PxIdentity)
-	);
-	springJoint->setStiffness(stiffness);
-	springJoint->setDamping(dampingConstant);
-	springJoint->setDistanceJointFlags(physx::PxDistanceJointFlag::eSPRING_ENABLED);
-	return springJoint;
-}
+	physx::PxSimulationStatistics statistics;
+	if (mSimulationStatsEnabled || mBroadPhaseProfiling) {
+		sceneState.mScene->getSimulationStatistics(statistics);
+	}
 
-int PhysicsSystem::registerMaterial(const float staticFriction = 0.5f, const float dynamicFriction = 0.5f, const float restitution = 0.0f) {
-	mMaterialCount++;
-	physx::PxMaterial* material = mPhysics->createMaterial(staticFriction, dynamicFriction, restitution);
-	mMaterialRegistry.insert(std::pair<int, physx::PxMaterial*>(mMaterialCount, material));
-	return mMaterialCount;
-}
+	if (mSimulationStatsEnabled) {
+		SimulationStats& stats = sceneState.mSimulationStats;
+		stats.mFetchTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - fetchStart).count();
+		stats.mSteps++;
+		stats.mDynamicBodies = statistics.nbDynamicBodies;
+		stats.mActiveDynamicBodies = statistics.nbActiveDynamicBodies;
+		stats.mActiveKinematicBodies = statistics.nbActiveKinematicBodies;
+		stats.mStaticBodies = statistics.nbStaticBodies;
+		stats.mBroadPhaseAdds += statistics.getNbBroadPhaseAdds();
+		stats.mBroadPhaseRemoves += statistics.getNbBroadPhaseRemoves();
+		stats.mContactPairs = statistics.nbDiscreteContactPairsTotal;
+		stats.mTouchingPairs = statistics.nbDiscreteContactPairsWithContacts;
+		stats.mNewTouches = statistics.nbNewTouches;
+		stats.mLostTouches = statistics.nbLostTouches;
+	}
 
-physx::PxMaterial* PhysicsSystem::getMaterial(const int id) {
-	return mMaterialRegistry[id];
+	if (mBroadPhaseProfiling) {
+		BroadPhaseStats& stats = sceneState.mBroadPhaseStats;
+		stats.mSteps++;
+		stats.mAdds += statistics.getNbBroadPhaseAdds();
+		stats.mRemoves += statistics.getNbBroadPhaseRemoves();
+		stats.mContactPairs = statistics.nbDiscreteContactPairsTotal;
+	}
 }
 
-void PhysicsSystem::setMaximumLinearVelocity(entityx::Entity& entity, float maximumVelocity) {
-	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
+void PhysicsSystem::handleOutOfBounds(entityx::EntityManager& entities) {
+	for (auto& sceneState : mScenes) {
+		std::vector<entityx::Entity::Id>& outOfBounds = sceneState->mBroadPhaseEvents.mOutOfBounds;
+		if (outOfBounds.empty()) {
+			continue;
+		}
 
-	if (body.valid()) {
-		body->getBody()->setMaxLinearVelocity(maximumVelocity);
+		// an actor with several shapes is reported once per shape
+		std::sort(outOfBounds.begin(), outOfBounds.end());
+		outOfBounds.erase(std::unique(outOfBounds.begin(), outOfBounds.end()), outOfBounds.end());
+
+		for (auto& id : outOfBounds) {
+			if (!entities.valid(id)) {
+				continue;
+			}
+			sceneState->mBroadPhaseStats.mOutOfBounds++;
+			if (mOutOfBoundsFn) {
+				mOutOfBoundsFn(entities.get(id));
+			}
+			else {
+				std::cout << "sitara::ecs::PhysicsSystem -- entity " << id << " left the broadphase world bounds and will no longer collide." << std::endl;
+			}
+		}
+		outOfBounds.clear();
+	}
+}
+
+void PhysicsSystem::syncDynamicBodies(entityx::EntityManager& entities) {
+	// only bodies PhysX moved in the last step; sleeping bodies cost nothing here
+	gatherActiveBodies(entities);
+
+	mSyncedBodies.clear();
+	for (auto& body : mActiveBodies) {
+		entityx::ComponentHandle<sitara::ecs::Transform> transform = body.entity().component<sitara::ecs::Transform>();
+		if (!transform.valid() || body->isKinematic()) {
+			// kinematic bodies follow their Transform, not the other way round
+			continue;
+		}
+
+		if (mFixedTimeStep > 0.0f) {
+			// render the state alpha of the way from the previous step to the latest one
+			transform->mPosition = body->getInterpolatedPosition(mInterpolationAlpha);
+			transform->mOrientation = body->getInterpolatedRotation(mInterpolationAlpha);
+			mSyncedBodies.push_back(body.entity().id());
+		}
+		else {
+			physx::PxTransform pose = body->mBody->getGlobalPose();
+			transform->mPosition = sitara::ecs::physics::from(pose.p);
+			transform->mOrientation = sitara::ecs::physics::from(pose.q);
+		}
+	}
+
+	if (mFixedTimeStep > 0.0f) {
+		/*
+		* Interpolated bodies that fell asleep were last drawn part of the way between two steps.
+		* Snap them to their final pose once, and settle their previous pose so they don't need saving while asleep.
+		*/
+		std::sort(mSyncedBodies.begin(), mSyncedBodies.end());
+		for (auto& id : mPreviousSyncedBodies) {
+			if (std::binary_search(mSyncedBodies.begin(), mSyncedBodies.end(), id) || !entities.valid(id)) {
+				continue;
+			}
+			entityx::Entity entity = entities.get(id);
+			entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
+			entityx::ComponentHandle<sitara::ecs::Transform> transform = entity.component<sitara::ecs::Transform>();
+			if (body.valid() && transform.valid()) {
+				body->savePreviousPose();
+				transform->mPosition = body->getPosition();
+				transform->mOrientation = body->getRotation();
+			}
+		}
+		mPreviousSyncedBodies.swap(mSyncedBodies);
+	}
+}
+
+void PhysicsSystem::gatherActiveBodies(entityx::EntityManager& entities) {
+	mActiveBodies.clear();
+
+	/*
+	* Bodies may have been destroyed, parked or moved to another scene since the last fetchResults(), so the copied
+	* actors are only matched against each entity's current DynamicBody and never touched themselves.
+	*/
+	for (auto& sceneState : mScenes) {
+		for (size_t i = 0; i < sceneState->mActiveEntities.size(); i++) {
+			entityx::Entity::Id id = sceneState->mActiveEntities[i];
+			if (!entities.valid(id)) {
+				continue;
+			}
+
+			entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entities.get(id).component<sitara::ecs::DynamicBody>();
+			if (body.valid() && body->mBody == sceneState->mActiveActors[i]) {
+				mActiveBodies.push_back(body);
+			}
+		}
+	}
+}
+
+void PhysicsSystem::driveKinematicBodies(uint32_t remainingSteps) {
+	// kept up to date by setKinematic() and the DynamicBody receivers, so sleeping props are never visited
+	for (auto& body : mKinematicBodies) {
+		entityx::ComponentHandle<sitara::ecs::Transform> transform = body.entity().component<sitara::ecs::Transform>();
+		if (!transform.valid()) {
+			continue;
+		}
+		physx::PxTransform pose = body->mBody->getGlobalPose();
+		physx::PxTransform target = sitara::ecs::physics::to(transform->mOrientation, transform->mPosition);
+		if (target.p == pose.p && target.q == pose.q) {
+			continue;
+		}
+
+		if (remainingSteps > 1) {
+			// spread the update's motion over its sub-steps so a fast tween sweeps through them instead of jumping in the first
+			float t = 1.0f / remainingSteps;
+			target = sitara::ecs::physics::to(glm::slerp(sitara::ecs::physics::from(pose.q), transform->mOrientation, t),
+											  glm::mix(sitara::ecs::physics::from(pose.p), transform->mPosition, t));
+		}
+		body->mBody->setKinematicTarget(target);
+	}
+}
+
+void PhysicsSystem::promoteStaticBody(entityx::Entity entity) {
+	entityx::ComponentHandle<sitara::ecs::StaticBody> staticBody = entity.component<sitara::ecs::StaticBody>();
+	physx::PxRigidStatic* staticActor = staticBody->mBody;
+	physx::PxShape* mainShape = staticBody->mShape;
+
+	physx::PxRigidDynamic* actor = mPhysics->createRigidDynamic(staticActor->getGlobalPose());
+	actor->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, true);
+
+	// the extra reference keeps each shape alive between leaving the static actor and joining the kinematic one
+	std::vector<physx::PxShape*> shapes(staticActor->getNbShapes());
+	staticActor->getShapes(shapes.data(), static_cast<physx::PxU32>(shapes.size()));
+	for (auto shape : shapes) {
+		shape->acquireReference();
+		staticActor->detachShape(*shape);
+		actor->attachShape(*shape);
+		shape->release();
+	}
+
+	physx::PxAggregate* aggregate = staticActor->getAggregate();
+	if (aggregate) {
+		aggregate->removeActor(*staticActor);
+		aggregate->addActor(*actor);
+	}
+	else {
+		staticActor->getScene()->addActor(*actor);
+	}
+
+	// ~StaticBody() releases the now empty static actor
+	entity.remove<sitara::ecs::StaticBody>();
+	entity.assign<sitara::ecs::DynamicBody>(actor)->mShape = mainShape;
+}
+
+void PhysicsSystem::applyCollisionLayers(entityx::EntityManager& entities) {
+	if (mLayerMasksChanged) {
+		// the matrix changed; every layered body needs its mask rewritten, which also refilters its pairs
+		entityx::ComponentHandle<LogicalLayer> layer;
+		for (auto entity : entities.entities_with_components(layer)) {
+			refreshCollisionLayer(entity);
+		}
+		mLayerMasksChanged = false;
+	}
+	else {
+		for (auto& id : mPendingLayerEntities) {
+			if (entities.valid(id)) {
+				refreshCollisionLayer(entities.get(id));
+			}
+		}
+	}
+	mPendingLayerEntities.clear();
+}
+
+void PhysicsSystem::emitSimulationEvents(entityx::EntityManager& entities, entityx::EventManager& events) {
+	// pairs were buffered during fetchResults(); either side may have been destroyed since
+	mTriggerEvents.clear();
+	mContactEvents.clear();
+	for (auto& sceneState : mScenes) {
+		for (auto& pair : sceneState->mSimulationEvents.mTriggers) {
+			if (entities.valid(pair.mTrigger) && entities.valid(pair.mOther)) {
+				TriggerEvent trigger;
+				trigger.mTrigger = entities.get(pair.mTrigger);
+				trigger.mOther = entities.get(pair.mOther);
+				trigger.mEntered = pair.mEntered;
+				mTriggerEvents.push_back(trigger);
+			}
+		}
+
+		for (auto& pair : sceneState->mSimulationEvents.mContacts) {
+			if (entities.valid(pair.mFirst) && entities.valid(pair.mSecond)) {
+				ContactEvent contact;
+				contact.mFirst = entities.get(pair.mFirst);
+				contact.mSecond = entities.get(pair.mSecond);
+				contact.mBegan = pair.mBegan;
+				contact.mPoint = pair.mPoint;
+				contact.mNormal = pair.mNormal;
+				mContactEvents.push_back(contact);
+			}
+		}
+
+		sceneState->mSimulationEvents.clear();
+	}
+
+	if (!mTriggerEvents.empty()) {
+		events.emit<TriggerEvents>(mTriggerEvents);
+	}
+	if (!mContactEvents.empty()) {
+		events.emit<ContactEvents>(mContactEvents);
+	}
+}
+
+void PhysicsSystem::fetchPendingResults() {
+	if (mSimulationPending) {
+		fetchStepResults();
+		mSimulationPending = false;
+	}
+}
+
+void PhysicsSystem::receive(const entityx::ComponentAddedEvent<sitara::ecs::DynamicBody>& event) {
+	/*
+	Link the user application entityx::Entity::Id to the NVIDIA PhysX object using the userData pointer.
+	Note that this is NOT a pointer to the entity; it's the entity's literal id number.
+	use ->getUserData() to get the entity's ID and mEntities.get(id); to get the entity handle directly
+	*/
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = event.component;
+	body->mBody->userData = (void*)(event.entity.id().id());
+	if (mIncrementalOverlaps) {
+		mAddedOverlapBodies.push_back(event.entity.id());
+	}
+	if (body->isKinematic()) {
+		// promoted statics and snapshot bodies arrive already kinematic
+		mKinematicBodies.push_back(body);
+	}
+	if (event.entity.has_component<PhysicsScene>()) {
+		bindToScene(event.entity);
+	}
+	if (event.entity.has_component<LogicalLayer>()) {
+		// shapes are usually attached after the component, so the layer is written on the next update
+		mPendingLayerEntities.push_back(event.entity.id());
+	}
+}
+
+void PhysicsSystem::receive(const entityx::ComponentRemovedEvent<sitara::ecs::DynamicBody>& event) {
+	// sent before the component is destroyed; take the actor so ~DynamicBody() doesn't release it
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = event.component;
+	invalidateOverlaps(body->mBody, event.entity.id());
+	if (body->isKinematic()) {
+		removeKinematicBody(event.entity.id());
+	}
+	if (body->mBody) {
+		removeFromAggregate(*body->mBody);
+	}
+	if (!mBodyPooling || body->mPoolIndex < 0 || !body->mBody) {
+		return;
+	}
+
+	BodyPool& pool = mBodyPools[body->mPoolIndex];
+	if (pool.mParked.size() >= mMaxParkedBodies) {
+		return;
+	}
+
+	physx::PxRigidDynamic* actor = body->mBody;
+	body->setKinematic(false);
+	if (actor->getScene()) {
+		actor->getScene()->removeActor(*actor, false);
+	}
+	actor->userData = nullptr;
+	pool.mParked.push_back(actor);
+	body->mBody = nullptr;
+}
+
+void PhysicsSystem::receive(const entityx::ComponentAddedEvent<sitara::ecs::StaticBody>& event) {
+	/*
+	Link the user application entityx::Entity::Id to the NVIDIA PhysX object using the userData pointer.
+	Note that this is NOT a pointer to the entity; it's the entity's literal id number.
+	use ->getUserData() to get the entity's ID and mEntities.get(id); to get the entity handle directly
+	*/
+	entityx::ComponentHandle<sitara::ecs::StaticBody> body = event.component;
+	body->mBody->userData = (void*)(event.entity.id().id());
+	if (mIncrementalOverlaps) {
+		mAddedOverlapBodies.push_back(event.entity.id());
+	}
+	if (event.entity.has_component<PhysicsScene>()) {
+		bindToScene(event.entity);
+	}
+	if (event.entity.has_component<LogicalLayer>()) {
+		mPendingLayerEntities.push_back(event.entity.id());
+	}
+}
+
+void PhysicsSystem::receive(const entityx::ComponentRemovedEvent<sitara::ecs::StaticBody>& event) {
+	entityx::ComponentHandle<sitara::ecs::StaticBody> body = event.component;
+	invalidateOverlaps(body->mBody, event.entity.id());
+	if (body->mBody) {
+		removeFromAggregate(*body->mBody);
+	}
+}
+
+void PhysicsSystem::receive(const entityx::ComponentAddedEvent<LogicalLayer>& event) {
+	mPendingLayerEntities.push_back(event.entity.id());
+}
+
+void PhysicsSystem::receive(const entityx::ComponentAddedEvent<PhysicsScene>& event) {
+	bindToScene(event.entity);
+}
+
+uint32_t PhysicsSystem::getSceneIndex(entityx::Entity entity) {
+	if (entity.has_component<PhysicsScene>()) {
+		uint32_t sceneIndex = entity.component<PhysicsScene>()->mSceneIndex;
+		if (sceneIndex < mScenes.size()) {
+			return sceneIndex;
+		}
+	}
+	return 0;
+}
+
+uint32_t PhysicsSystem::validateSceneIndex(uint32_t sceneIndex) {
+	if (sceneIndex >= mScenes.size()) {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- scene " << sceneIndex << " doesn't exist; using scene 0." << std::endl;
+		return 0;
+	}
+	return sceneIndex;
+}
+
+void PhysicsSystem::bindToScene(entityx::Entity entity) {
+	uint32_t sceneIndex = entity.component<PhysicsScene>()->mSceneIndex;
+	if (sceneIndex >= mScenes.size()) {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- scene " << sceneIndex << " doesn't exist; the body stays in its current scene." << std::endl;
+		return;
+	}
+
+	physx::PxRigidActor* actor = nullptr;
+	if (entity.has_component<sitara::ecs::DynamicBody>()) {
+		actor = entity.component<sitara::ecs::DynamicBody>()->mBody;
+	}
+	else if (entity.has_component<sitara::ecs::StaticBody>()) {
+		actor = entity.component<sitara::ecs::StaticBody>()->mBody;
+	}
+
+	physx::PxScene* scene = mScenes[sceneIndex]->mScene;
+	if (!actor || !actor->getScene() || actor->getScene() == scene) {
+		// bodies not in a scene yet are added to the right one by whoever inserts them
+		return;
+	}
+
+	// the scenes may be mid-step in async mode; actors can only change scenes between steps
+	fetchPendingResults();
+	removeFromAggregate(*actor);
+	if (actor->getScene()) {
+		actor->getScene()->removeActor(*actor);
+	}
+	scene->addActor(*actor);
+	// detectors in the old scene that saw the body find it through its id
+	invalidateOverlaps(actor, entity.id());
+}
+
+void PhysicsSystem::removeFromAggregate(physx::PxRigidActor& actor) {
+	physx::PxAggregate* aggregate = actor.getAggregate();
+	if (!aggregate) {
+		return;
+	}
+
+	// the aggregate can't be touched while its scene is stepping
+	fetchPendingResults();
+	aggregate->removeActor(actor);
+	if (aggregate->getNbActors() == 0) {
+		// an emptied aggregate would otherwise stay in the scene until the system goes away
+		mAggregates.erase(std::remove(mAggregates.begin(), mAggregates.end(), aggregate), mAggregates.end());
+		aggregate->release();
+	}
+}
+
+double PhysicsSystem::getElapsedSimulationTime() {
+	return mSimulationTime;
+}
+
+void PhysicsSystem::setFixedTimeStep(float stepSize, uint32_t maxSubSteps) {
+	mFixedTimeStep = std::max(stepSize, 0.0f);
+	mMaxSubSteps = std::max(maxSubSteps, 1u);
+	mAccumulator = 0.0f;
+	mInterpolationAlpha = 1.0f;
+}
+
+float PhysicsSystem::getFixedTimeStep() {
+	return mFixedTimeStep;
+}
+
+float PhysicsSystem::getInterpolationAlpha() {
+	return mInterpolationAlpha;
+}
+
+void PhysicsSystem::enableAsyncSimulation(const bool enable) {
+	if (!enable) {
+		fetchPendingResults();
+	}
+	mAsyncSimulation = enable;
+}
+
+bool PhysicsSystem::isAsyncSimulationEnabled() {
+	return mAsyncSimulation;
+}
+
+void PhysicsSystem::setJobPool(JobPool* pool) {
+	mJobPool = pool;
+}
+
+void PhysicsSystem::enableMultithreadedQueries(const bool enable) {
+	mMultithreadedQueries = enable;
+}
+
+void PhysicsSystem::runPreUpdateFns(entityx::EntityManager& entities) {
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body;
+	entityx::ComponentHandle<sitara::ecs::Transform> transform;
+
+	for (auto entity : entities.entities_with_components(body, transform)) {
+		for (auto callback : mPreUpdateFns) {
+			callback(body);
+		}
+	}
+}
+
+void PhysicsSystem::setGravity(const ci::vec3& gravity) {
+	if (mScene) {
+		for (auto& sceneState : mScenes) {
+			sceneState->mScene->setGravity(physx::PxVec3(gravity.x, gravity.y, gravity.z));
+		}
+	}
+	else {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- must configure() system before you can set gravity." << std::endl;
+	}
+}
+
+void PhysicsSystem::setLayerCollision(int layerA, int layerB, bool collide) {
+	if (layerA < 0 || layerA >= 32 || layerB < 0 || layerB >= 32) {
+		std::cout << "sitara::ecs::PhysicsSystem -- collision layers must be between 0 and 31." << std::endl;
+		return;
+	}
+
+	// keep the matrix symmetric
+	if (collide) {
+		mLayerMasks[layerA] |= (1u << layerB);
+		mLayerMasks[layerB] |= (1u << layerA);
+	}
+	else {
+		mLayerMasks[layerA] &= ~(1u << layerB);
+		mLayerMasks[layerB] &= ~(1u << layerA);
+	}
+	mLayerMasksChanged = true;
+}
+
+bool PhysicsSystem::getLayerCollision(int layerA, int layerB) {
+	if (layerA < 0 || layerA >= 32 || layerB < 0 || layerB >= 32) {
+		return true;
+	}
+	return (mLayerMasks[layerA] & (1u << layerB)) != 0;
+}
+
+void PhysicsSystem::refreshCollisionLayer(entityx::Entity entity) {
+	physx::PxRigidActor* actor = nullptr;
+	if (entity.has_component<sitara::ecs::DynamicBody>()) {
+		actor = entity.component<sitara::ecs::DynamicBody>()->mBody;
+	}
+	else if (entity.has_component<sitara::ecs::StaticBody>()) {
+		actor = entity.component<sitara::ecs::StaticBody>()->mBody;
+	}
+	if (!actor) {
+		return;
+	}
+
+	physx::PxU32 group = 0;
+	physx::PxU32 mask = ~physx::PxU32(0);
+	if (entity.has_component<LogicalLayer>()) {
+		int layerId = entity.component<LogicalLayer>()->mLayerId;
+		if (layerId >= 0 && layerId < 32) {
+			group = 1u << layerId;
+			mask = mLayerMasks[layerId];
+		}
+		else {
+			std::cout << "sitara::ecs::PhysicsSystem -- layer " << layerId << " is outside 0-31; the body collides with every layer." << std::endl;
+		}
+	}
+
+	physx::PxU32 previousLayer = 0;
+	bool queryLayerChanged = false;
+	physx::PxShape* shapes[8];
+	physx::PxU32 shapeCount = actor->getNbShapes();
+	for (physx::PxU32 start = 0; start < shapeCount; start += 8) {
+		physx::PxU32 count = actor->getShapes(shapes, 8, start);
+		for (physx::PxU32 i = 0; i < count; i++) {
+			// word2 holds the contact report flags; leave it alone
+			physx::PxFilterData filterData = shapes[i]->getSimulationFilterData();
+			if (filterData.word0 != group || filterData.word1 != mask) {
+				filterData.word0 = group;
+				filterData.word1 = mask;
+				shapes[i]->setSimulationFilterData(filterData);
+			}
+
+			// OverlapDetector layer masks test the same bit against the query filter data
+			physx::PxFilterData queryData = shapes[i]->getQueryFilterData();
+			if (queryData.word0 != group) {
+				previousLayer |= queryData.word0;
+				queryLayerChanged = true;
+				queryData.word0 = group;
+				shapes[i]->setQueryFilterData(queryData);
+			}
+		}
+	}
+	if (queryLayerChanged) {
+		invalidateOverlaps(actor, entity.id(), previousLayer);
+	}
+}
+
+void PhysicsSystem::enableStaticPromotion(const bool enable, uint32_t promotionThreshold) {
+	mStaticPromotion = enable;
+	mPromotionThreshold = std::max(promotionThreshold, 1u);
+}
+
+void PhysicsSystem::setBroadPhase(physx::PxBroadPhaseType::Enum type) {
+	if (!mScene) {
+		mBroadPhaseType = type;
+	}
+	else {
+		std::cout << "Broadphase must be chosen before running PhysicsSystem::configure(); keeping the current one." << std::endl;
+	}
+}
+
+void PhysicsSystem::setWorldBounds(const ci::AxisAlignedBox& bounds, uint32_t subdivisions) {
+	if (!mScene) {
+		mWorldBounds = bounds;
+		mWorldSubdivisions = std::min(std::max(subdivisions, 1u), 16u);
+		mHasWorldBounds = true;
+	}
+	else {
+		std::cout << "World bounds must be set before running PhysicsSystem::configure(); ignoring them." << std::endl;
+	}
+}
+
+void PhysicsSystem::setOutOfBoundsFn(std::function<void(entityx::Entity entity)> callback) {
+	mOutOfBoundsFn = callback;
+}
+
+void PhysicsSystem::enableBroadPhaseProfiling(const bool enable) {
+	mBroadPhaseProfiling = enable;
+}
+
+const PhysicsSystem::BroadPhaseStats& PhysicsSystem::getBroadPhaseStats(uint32_t sceneIndex) {
+	static const BroadPhaseStats noStats = BroadPhaseStats();
+	if (sceneIndex >= mScenes.size()) {
+		return noStats;
+	}
+	return mScenes[sceneIndex]->mLastBroadPhaseStats;
+}
+
+void PhysicsSystem::enableVisualDebugger(const std::string& host, int port, unsigned int timeoutMs, physx::PxPvdInstrumentationFlags flags) {
+	if (!mFoundation) {
+		mPvdEnabled = true;
+		mPvdHost = host;
+		mPvdPort = port;
+		mPvdTimeout = timeoutMs;
+		mPvdFile.clear();
+		mPvdFlags = flags;
+	}
+	else {
+		std::cout << "The visual debugger must be enabled before running PhysicsSystem::configure()." << std::endl;
+	}
+}
+
+void PhysicsSystem::captureVisualDebuggerToFile(const ci::fs::path& path, physx::PxPvdInstrumentationFlags flags) {
+	if (!mFoundation) {
+		mPvdEnabled = true;
+		mPvdFile = path;
+		mPvdFlags = flags;
+	}
+	else {
+		std::cout << "The visual debugger must be enabled before running PhysicsSystem::configure()." << std::endl;
+	}
+}
+
+void PhysicsSystem::enableSimulationStats(const bool enable) {
+	mSimulationStatsEnabled = enable;
+}
+
+const PhysicsSystem::SimulationStats& PhysicsSystem::getSimulationStats(uint32_t sceneIndex) {
+	static const SimulationStats noStats = SimulationStats();
+	if (sceneIndex >= mScenes.size()) {
+		return noStats;
+	}
+	return mScenes[sceneIndex]->mLastSimulationStats;
+}
+
+uint32_t PhysicsSystem::createScene() {
+	if (!mScene) {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- must configure() system before you can create scenes." << std::endl;
+		return 0;
+	}
+	// the new scene must not start while the others are mid-step
+	fetchPendingResults();
+	addScene();
+	return static_cast<uint32_t>(mScenes.size() - 1);
+}
+
+uint32_t PhysicsSystem::getNumberOfScenes() {
+	return static_cast<uint32_t>(mScenes.size());
+}
+
+physx::PxScene* PhysicsSystem::getScene(uint32_t sceneIndex) {
+	return (sceneIndex < mScenes.size()) ? mScenes[sceneIndex]->mScene : nullptr;
+}
+
+void PhysicsSystem::enableAllocationNames(const bool enable) {
+	mReportAllocationNames = enable;
+	if (mFoundation) {
+		mFoundation->setReportAllocationNames(enable);
+	}
+}
+
+void PhysicsSystem::enablePooledAllocations(const bool enable) {
+	mAllocator.enablePooling(enable);
+}
+
+MemoryStats PhysicsSystem::getMemoryStats() {
+	return mAllocator.getStats();
+}
+
+void PhysicsSystem::setNumberOfThreads(const uint32_t numThreads) {
+	if (!mScene) {
+		mNumberOfThreads = numThreads;
+	}
+	else {
+		std::cout << "Number of threads must be set before running PhysicsSystem::configure(); keeping the current dispatcher." << std::endl;
+	}
+}
+
+void PhysicsSystem::enableGpu(const bool enable) {
+	if (!mScene) {
+		std::cout << "GPU features are currently only available for dynamic builds; until a future time these features are disabled." << std::endl;
+		mGpuEnabled = true;
+	}
+	else {
+		std::cout << "GPU must be enabled before running PhysicsSystem::configure(); using CPU dispatcher instead." << std::endl;
+	}
+}
+
+physx::PxRigidStatic* PhysicsSystem::createStaticBody(const ci::vec3& position, const ci::quat& rotation, uint32_t sceneIndex) {
+	physx::PxTransform transform = sitara::ecs::physics::to(rotation, position);
+	physx::PxRigidStatic* body = mPhysics->createRigidStatic(transform);
+	mScenes[validateSceneIndex(sceneIndex)]->mScene->addActor(*body);
+	return body;
+}
+
+physx::PxRigidDynamic* PhysicsSystem::createDynamicBody(const ci::vec3& position, const ci::quat& rotation, uint32_t sceneIndex) {
+	physx::PxTransform transform = sitara::ecs::physics::to(rotation, position);
+	physx::PxRigidDynamic* body = mPhysics->createRigidDynamic(transform);
+	mScenes[validateSceneIndex(sceneIndex)]->mScene->addActor(*body);
+	return body;
+}
+
+std::vector<entityx::Entity> PhysicsSystem::createDynamicBodies(entityx::EntityManager& entities, const BodyTemplate& bodyTemplate,
+																  const std::vector<ci::vec3>& positions, uint32_t aggregateSize, uint32_t sceneIndex) {
+	std::vector<entityx::Entity> spawned;
+	spawned.reserve(positions.size());
+	std::vector<physx::PxActor*> actors;
+	actors.reserve(positions.size());
+	sceneIndex = validateSceneIndex(sceneIndex);
+	physx::PxScene* scene = mScenes[sceneIndex]->mScene;
+
+	for (auto& position : positions) {
+		int poolIndex = -1;
+		physx::PxShape* shape = nullptr;
+		physx::PxTransform pose(sitara::ecs::physics::to(position));
+		physx::PxRigidDynamic* actor = acquireActor(bodyTemplate, pose, poolIndex, shape);
+		actors.push_back(actor);
+
+		// a fresh entity has no Transform yet; give it one that matches the actor before the body goes on
+		entityx::Entity entity = entities.create();
+		entity.assign<sitara::ecs::Transform>(position)->mOrientation = sitara::ecs::physics::from(pose.q);
+		entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.assign<sitara::ecs::DynamicBody>(actor);
+		body->mShape = shape;
+		body->mPoolIndex = poolIndex;
+		if (sceneIndex != 0) {
+			// the actor isn't in a scene yet, so this only records where it belongs
+			entity.assign<PhysicsScene>(sceneIndex);
+		}
+		spawned.push_back(entity);
+	}
+
+	if (aggregateSize == 0) {
+		scene->addActors(actors.data(), static_cast<physx::PxU32>(actors.size()));
+		return spawned;
+	}
+
+	aggregateSize = std::min(aggregateSize, 128u);
+	for (size_t begin = 0; begin < actors.size(); begin += aggregateSize) {
+		size_t end = std::min(begin + aggregateSize, actors.size());
+		physx::PxAggregate* aggregate = mPhysics->createAggregate(static_cast<physx::PxU32>(end - begin), false);
+		for (size_t i = begin; i < end; i++) {
+			aggregate->addActor(*static_cast<physx::PxRigidActor*>(actors[i]));
+		}
+		scene->addAggregate(*aggregate);
+		mAggregates.push_back(aggregate);
+	}
+	return spawned;
+}
+
+void PhysicsSystem::enableBodyPooling(const bool enable, size_t maxParkedPerTemplate) {
+	mBodyPooling = enable;
+	mMaxParkedBodies = maxParkedPerTemplate;
+}
+
+entityx::ComponentHandle<DynamicBody> PhysicsSystem::assignDynamicBody(entityx::Entity entity, const BodyTemplate& bodyTemplate,
+																	   const ci::vec3& position, const ci::quat& rotation) {
+	int poolIndex = -1;
+	physx::PxShape* shape = nullptr;
+	physx::PxRigidDynamic* actor = acquireActor(bodyTemplate, sitara::ecs::physics::to(rotation, position), poolIndex, shape);
+	mScenes[getSceneIndex(entity)]->mScene->addActor(*actor);
+
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.assign<sitara::ecs::DynamicBody>(actor);
+	body->mShape = shape;
+	body->mPoolIndex = poolIndex;
+	if (entity.has_component<sitara::ecs::Transform>()) {
+		entity.component<sitara::ecs::Transform>()->mPosition = position;
+		entity.component<sitara::ecs::Transform>()->mOrientation = rotation;
+	}
+	return body;
+}
+
+physx::PxRigidDynamic* PhysicsSystem::acquireActor(const BodyTemplate& bodyTemplate, const physx::PxTransform& pose, int& poolIndex, physx::PxShape*& shape) {
+	poolIndex = -1;
+	if (mBodyPooling) {
+		for (size_t i = 0; i < mBodyPools.size(); i++) {
+			if (mBodyPools[i].mTemplate == bodyTemplate) {
+				poolIndex = static_cast<int>(i);
+				break;
+			}
+		}
+		if (poolIndex < 0) {
+			BodyPool pool;
+			pool.mTemplate = bodyTemplate;
+			mBodyPools.push_back(pool);
+			poolIndex = static_cast<int>(mBodyPools.size() - 1);
+		}
+
+		BodyPool& pool = mBodyPools[poolIndex];
+		if (!pool.mParked.empty()) {
+			physx::PxRigidDynamic* actor = pool.mParked.back();
+			pool.mParked.pop_back();
+
+			// same reset as DynamicBody::resetBody(), plus whatever the previous owner may have changed
+			actor->setGlobalPose(pose);
+			actor->setLinearVelocity(physx::PxVec3(0.0f));
+			actor->setAngularVelocity(physx::PxVec3(0.0f));
+			actor->clearForce();
+			actor->clearTorque();
+			actor->setLinearDamping(bodyTemplate.mLinearDamping);
+			actor->setAngularDamping(bodyTemplate.mAngularDamping);
+			actor->setMaxLinearVelocity(PX_MAX_F32);
+			actor->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, false);
+
+			actor->getShapes(&shape, 1);
+			if (shape && shape->isExclusive()) {
+				// the query data carries the previous owner's LogicalLayer bit, which OverlapDetector masks test
+				shape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, false);
+				shape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, true);
+				shape->setSimulationFilterData(physx::PxFilterData());
+				shape->setQueryFilterData(physx::PxFilterData());
+			}
+			// recomputes inertia and centre of mass too, in case the previous owner changed them
+			physx::PxRigidBodyExt::setMassAndUpdateInertia(*actor, bodyTemplate.mMass);
+			return actor;
+		}
+	}
+
+	physx::PxRigidDynamic* actor = mPhysics->createRigidDynamic(pose);
+	shape = bodyTemplate.attachTo(*actor);
+	physx::PxRigidBodyExt::setMassAndUpdateInertia(*actor, bodyTemplate.mMass);
+	actor->setLinearDamping(bodyTemplate.mLinearDamping);
+	actor->setAngularDamping(bodyTemplate.mAngularDamping);
+	return actor;
+}
+
+std::vector<entityx::Entity> PhysicsSystem::createStaticBodies(entityx::EntityManager& entities, const BodyTemplate& bodyTemplate,
+																 const std::vector<ci::vec3>& positions, uint32_t sceneIndex) {
+	std::vector<entityx::Entity> spawned;
+	spawned.reserve(positions.size());
+	std::vector<physx::PxActor*> actors;
+	actors.reserve(positions.size());
+	sceneIndex = validateSceneIndex(sceneIndex);
+
+	for (auto& position : positions) {
+		physx::PxTransform pose(sitara::ecs::physics::to(position));
+		physx::PxRigidStatic* actor = mPhysics->createRigidStatic(pose);
+		physx::PxShape* shape = bodyTemplate.attachTo(*actor);
+		actors.push_back(actor);
+
+		entityx::Entity entity = entities.create();
+		entity.assign<sitara::ecs::Transform>(position)->mOrientation = sitara::ecs::physics::from(pose.q);
+		entity.assign<sitara::ecs::StaticBody>(actor)->mShape = shape;
+		if (sceneIndex != 0) {
+			entity.assign<PhysicsScene>(sceneIndex);
+		}
+		spawned.push_back(entity);
+	}
+
+	mScenes[sceneIndex]->mScene->addActors(actors.data(), static_cast<physx::PxU32>(actors.size()));
+	return spawned;
+}
+
+physx::PxAggregate* PhysicsSystem::createAggregate(const std::vector<entityx::Entity>& group, bool selfCollision) {
+	fetchPendingResults();
+
+	std::vector<physx::PxRigidActor*> actors;
+	uint32_t sceneIndex = 0;
+	for (auto entity : group) {
+		if (!entity.valid()) {
+			continue;
+		}
+		if (actors.empty()) {
+			sceneIndex = getSceneIndex(entity);
+		}
+		if (entity.has_component<sitara::ecs::DynamicBody>()) {
+			actors.push_back(entity.component<sitara::ecs::DynamicBody>()->mBody);
+		}
+		else if (entity.has_component<sitara::ecs::StaticBody>()) {
+			actors.push_back(entity.component<sitara::ecs::StaticBody>()->mBody);
+		}
+	}
+
+	if (actors.empty() || actors.size() > 128) {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- an aggregate needs between 1 and 128 bodies, got " << actors.size() << std::endl;
+		return nullptr;
+	}
+
+	// the aggregate goes where the group's entities are bound (PhysicsScene); an aggregate can't span scenes
+	physx::PxScene* scene = mScenes[sceneIndex]->mScene;
+
+	// an actor can't join an aggregate while it's in the scene on its own
+	physx::PxAggregate* aggregate = mPhysics->createAggregate(static_cast<physx::PxU32>(actors.size()), selfCollision);
+	for (auto actor : actors) {
+		removeFromAggregate(*actor);
+		if (actor->getScene()) {
+			actor->getScene()->removeActor(*actor);
+		}
+		aggregate->addActor(*actor);
+	}
+	scene->addAggregate(*aggregate);
+	mAggregates.push_back(aggregate);
+	return aggregate;
+}
+
+physx::PxDistanceJoint* PhysicsSystem::createSpring(entityx::ComponentHandle<sitara::ecs::DynamicBody> body, ci::vec3 anchorPoint, float stiffness, float dampingConstant) {
+	// a joint between actors in different scenes is never simulated, so the anchor goes where the body is
+	auto staticAnchor = mPhysics->createRigidStatic(sitara::ecs::physics::to(ci::quat(0, ci::vec3(0, 0, 1)), anchorPoint));
+	physx::PxScene* scene = body->mBody->getScene() ? body->mBody->getScene() : mScene;
+	scene->addActor(*staticAnchor);
+
+	auto springJoint = physx::PxDistanceJointCreate(*mPhysics,
+		body->mBody,
+		physx::PxTransform(physx::PxIdentity),
+		staticAnchor,
+		physx::PxTransform(physx::PxIdentity)
+	);
+	springJoint->setStiffness(stiffness);
+	springJoint->setDamping(dampingConstant);
+	springJoint->setDistanceJointFlags(physx::PxDistanceJointFlag::eSPRING_ENABLED);
+	return springJoint;
+}
+
+int PhysicsSystem::registerMaterial(const float staticFriction = 0.5f, const float dynamicFriction = 0.5f, const float restitution = 0.0f) {
+	mMaterialCount++;
+	physx::PxMaterial* material = mPhysics->createMaterial(staticFriction, dynamicFriction, restitution);
+	mMaterialRegistry.insert(std::pair<int, physx::PxMaterial*>(mMaterialCount, material));
+	return mMaterialCount;
+}
+
+physx::PxMaterial* PhysicsSystem::getMaterial(const int id) {
+	return mMaterialRegistry[id];
+}
+
+physx::PxConvexMesh* PhysicsSystem::cookConvexMesh(const ci::TriMesh& mesh) {
+	uint64_t hash = hashMesh(mesh, "convex");
+	auto it = mConvexMeshes.find(hash);
+	if (it != mConvexMeshes.end()) {
+		return it->second;
+	}
+
+	ci::fs::path cachePath;
+	if (!mCookingCacheDirectory.empty()) {
+		cachePath = mCookingCacheDirectory / cacheFileName("convex", hash);
+	}
+
+	physx::PxConvexMesh* convexMesh = nullptr;
+	std::vector<uint8_t> cooked;
+	if (!cachePath.empty() && loadCookedMesh(cachePath, cooked)) {
+		physx::PxDefaultMemoryInputData input(cooked.data(), static_cast<physx::PxU32>(cooked.size()));
+		convexMesh = mPhysics->createConvexMesh(input);
+	}
+
+	if (!convexMesh) {
+		physx::PxConvexMeshDesc desc;
+		desc.points.count = static_cast<physx::PxU32>(mesh.getNumVertices());
+		desc.points.stride = sizeof(ci::vec3);
+		desc.points.data = mesh.getPositions<3>();
+		desc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
+
+		physx::PxDefaultMemoryOutputStream output;
+		if (!mCooking->cookConvexMesh(desc, output)) {
+			std::cout << "sitara::ecs::PhysicsSystem ERROR -- failed to cook convex mesh." << std::endl;
+			return nullptr;
+		}
+		if (!cachePath.empty()) {
+			saveCookedMesh(cachePath, output);
+		}
+
+		physx::PxDefaultMemoryInputData input(output.getData(), output.getSize());
+		convexMesh = mPhysics->createConvexMesh(input);
+	}
+
+	mConvexMeshes[hash] = convexMesh;
+	return convexMesh;
+}
+
+physx::PxTriangleMesh* PhysicsSystem::cookTriangleMesh(const ci::TriMesh& mesh) {
+	uint64_t hash = hashMesh(mesh, "triangles");
+	auto it = mTriangleMeshes.find(hash);
+	if (it != mTriangleMeshes.end()) {
+		return it->second;
+	}
+
+	ci::fs::path cachePath;
+	if (!mCookingCacheDirectory.empty()) {
+		cachePath = mCookingCacheDirectory / cacheFileName("triangles", hash);
+	}
+
+	physx::PxTriangleMesh* triangleMesh = nullptr;
+	std::vector<uint8_t> cooked;
+	if (!cachePath.empty() && loadCookedMesh(cachePath, cooked)) {
+		physx::PxDefaultMemoryInputData input(cooked.data(), static_cast<physx::PxU32>(cooked.size()));
+		triangleMesh = mPhysics->createTriangleMesh(input);
+	}
+
+	if (!triangleMesh) {
+		physx::PxTriangleMeshDesc desc;
+		desc.points.count = static_cast<physx::PxU32>(mesh.getNumVertices());
+		desc.points.stride = sizeof(ci::vec3);
+		desc.points.data = mesh.getPositions<3>();
+		desc.triangles.count = static_cast<physx::PxU32>(mesh.getNumTriangles());
+		desc.triangles.stride = 3 * sizeof(uint32_t);
+		desc.triangles.data = mesh.getIndices().data();
+
+		physx::PxDefaultMemoryOutputStream output;
+		if (!mCooking->cookTriangleMesh(desc, output)) {
+			std::cout << "sitara::ecs::PhysicsSystem ERROR -- failed to cook triangle mesh." << std::endl;
+			return nullptr;
+		}
+		if (!cachePath.empty()) {
+			saveCookedMesh(cachePath, output);
+		}
+
+		physx::PxDefaultMemoryInputData input(output.getData(), output.getSize());
+		triangleMesh = mPhysics->createTriangleMesh(input);
+	}
+
+	mTriangleMeshes[hash] = triangleMesh;
+	return triangleMesh;
+}
+
+void PhysicsSystem::setCookingCacheDirectory(const ci::fs::path& directory) {
+	mCookingCacheDirectory = directory;
+	mCookingCacheDirectorySet = true;
+}
+
+bool PhysicsSystem::loadCookedMesh(const ci::fs::path& path, std::vector<uint8_t>& data) {
+	std::ifstream file(path.string(), std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	data.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	return data.size() > 0 && file.read(reinterpret_cast<char*>(data.data()), data.size());
+}
+
+void PhysicsSystem::saveCookedMesh(const ci::fs::path& path, const physx::PxDefaultMemoryOutputStream& data) {
+	std::error_code error;
+	ci::fs::create_directories(path.parent_path(), error);
+
+	// write to a temporary name first so an interrupted launch never leaves a truncated cache entry behind
+	ci::fs::path temporary = path;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary.string(), std::ios::binary | std::ios::trunc);
+		if (!file || !file.write(reinterpret_cast<const char*>(data.getData()), data.getSize())) {
+			std::cout << "sitara::ecs::PhysicsSystem -- couldn't write cooking cache " << path << std::endl;
+			return;
+		}
+	}
+	ci::fs::rename(temporary, path, error);
+}
+
+physx::PxShape* PhysicsSystem::getSharedShape(physx::PxConvexMesh* mesh, physx::PxMaterial* material, const ci::vec3& scale) {
+	return getSharedShape(physx::PxConvexMeshGeometry(mesh, physx::PxMeshScale(sitara::ecs::physics::to(scale))), mesh, material, scale);
+}
+
+physx::PxShape* PhysicsSystem::getSharedShape(physx::PxTriangleMesh* mesh, physx::PxMaterial* material, const ci::vec3& scale) {
+	return getSharedShape(physx::PxTriangleMeshGeometry(mesh, physx::PxMeshScale(sitara::ecs::physics::to(scale))), mesh, material, scale);
+}
+
+physx::PxShape* PhysicsSystem::getSharedShape(const physx::PxGeometry& geometry, const void* mesh, physx::PxMaterial* material, const ci::vec3& scale) {
+	if (!mesh || !material) {
+		return nullptr;
+	}
+
+	auto key = std::make_tuple(mesh, material, scale.x, scale.y, scale.z);
+	auto it = mSharedShapes.find(key);
+	if (it != mSharedShapes.end()) {
+		return it->second;
+	}
+
+	physx::PxShape* shape = mPhysics->createShape(geometry, *material, false);
+	mSharedShapes[key] = shape;
+	return shape;
+}
+
+bool PhysicsSystem::saveSnapshot(entityx::EntityManager& entities, const ci::fs::path& path) {
+	fetchPendingResults();
+
+	physx::PxCollection* collection = physx::PxCollectionExt::createCollection(*mScene);
+
+	// ids are offset by one because 0 is PX_SERIAL_OBJECT_ID_INVALID; only scene 0's bodies are in the collection
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> dynamicBody;
+	for (auto entity : entities.entities_with_components(dynamicBody)) {
+		if (dynamicBody->mBody->getScene() == mScene) {
+			collection->addId(*dynamicBody->mBody, physx::PxSerialObjectId(entity.id().id() + 1));
+		}
+	}
+	entityx::ComponentHandle<sitara::ecs::StaticBody> staticBody;
+	for (auto entity : entities.entities_with_components(staticBody)) {
+		if (staticBody->mBody->getScene() == mScene) {
+			collection->addId(*staticBody->mBody, physx::PxSerialObjectId(entity.id().id() + 1));
+		}
+	}
+
+	physx::PxSerialization::complete(*collection, *mSerializationRegistry);
+
+	bool saved = false;
+	std::error_code error;
+	ci::fs::create_directories(path.parent_path(), error);
+	physx::PxDefaultFileOutputStream output(path.string().c_str());
+	if (output.isValid()) {
+		saved = physx::PxSerialization::serializeCollectionToBinary(output, *collection, *mSerializationRegistry);
+	}
+	collection->release();
+
+	if (!saved) {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- couldn't save snapshot to " << path << std::endl;
+	}
+	return saved;
+}
+
+bool PhysicsSystem::loadSnapshot(entityx::EntityManager& entities, const ci::fs::path& path,
+								 std::function<void(entityx::Entity entity, uint64_t savedEntityId)> onEntityFn) {
+	fetchPendingResults();
+
+	std::ifstream file(path.string(), std::ios::binary | std::ios::ate);
+	if (!file) {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- couldn't open snapshot " << path << std::endl;
+		return false;
+	}
+	size_t size = static_cast<size_t>(file.tellg());
+	file.seekg(0);
+
+	// the collection is deserialized in place, so its memory has to stay around for as long as the objects do
+	std::unique_ptr<uint8_t[]> memory(new uint8_t[size + PX_SERIAL_FILE_ALIGN]);
+	void* aligned = reinterpret_cast<void*>((reinterpret_cast<size_t>(memory.get()) + PX_SERIAL_FILE_ALIGN - 1) & ~size_t(PX_SERIAL_FILE_ALIGN - 1));
+	if (!file.read(static_cast<char*>(aligned), size)) {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- couldn't read snapshot " << path << std::endl;
+		return false;
+	}
+
+	physx::PxCollection* collection = physx::PxSerialization::createCollectionFromBinary(aligned, *mSerializationRegistry);
+	if (!collection) {
+		std::cout << "sitara::ecs::PhysicsSystem ERROR -- " << path << " is not a valid snapshot for this PhysX build" << std::endl;
+		return false;
+	}
+	mSnapshotMemory.push_back(std::move(memory));
+
+	// aggregated actors go into the scene with their aggregate; PhysX rejects them on their own
+	std::vector<physx::PxRigidActor*> statics;
+	std::vector<physx::PxActor*> dynamics;
+	std::vector<physx::PxAggregate*> aggregates;
+	for (physx::PxU32 i = 0; i < collection->getNbObjects(); i++) {
+		physx::PxBase& object = collection->getObject(i);
+		if (physx::PxRigidStatic* staticActor = object.is<physx::PxRigidStatic>()) {
+			if (!staticActor->getAggregate()) {
+				statics.push_back(staticActor);
+			}
+		}
+		else if (physx::PxRigidDynamic* dynamicActor = object.is<physx::PxRigidDynamic>()) {
+			if (!dynamicActor->getAggregate()) {
+				dynamics.push_back(dynamicActor);
+			}
+		}
+		else if (physx::PxAggregate* aggregate = object.is<physx::PxAggregate>()) {
+			aggregates.push_back(aggregate);
+		}
+		else if (physx::PxMaterial* material = object.is<physx::PxMaterial>()) {
+			mMaterialRegistry[++mMaterialCount] = material;
+		}
+	}
+
+	if (!statics.empty()) {
+		physx::PxPruningStructure* pruningStructure = mPhysics->createPruningStructure(statics.data(), static_cast<physx::PxU32>(statics.size()));
+		if (pruningStructure) {
+			mScene->addActors(*pruningStructure);
+			pruningStructure->release();
+		}
+		else {
+			for (auto actor : statics) {
+				mScene->addActor(*actor);
+			}
+		}
+	}
+	if (!dynamics.empty()) {
+		mScene->addActors(dynamics.data(), static_cast<physx::PxU32>(dynamics.size()));
+	}
+	for (auto aggregate : aggregates) {
+		mScene->addAggregate(*aggregate);
+		mAggregates.push_back(aggregate);
+	}
+
+	// re-link: a new entity per tagged actor; the ComponentAdded receivers point userData at it
+	for (physx::PxU32 i = 0; i < collection->getNbObjects(); i++) {
+		physx::PxBase& object = collection->getObject(i);
+		physx::PxSerialObjectId id = collection->getId(object);
+		if (id == PX_SERIAL_OBJECT_ID_INVALID) {
+			continue;
+		}
+
+		physx::PxRigidActor* actor = object.is<physx::PxRigidActor>();
+		if (!actor) {
+			continue;
+		}
+		physx::PxShape* shape = nullptr;
+		actor->getShapes(&shape, 1);
+
+		entityx::Entity entity = entities.create();
+		if (physx::PxRigidDynamic* dynamicActor = actor->is<physx::PxRigidDynamic>()) {
+			entity.assign<sitara::ecs::DynamicBody>(dynamicActor)->mShape = shape;
+		}
+		else if (physx::PxRigidStatic* staticActor = actor->is<physx::PxRigidStatic>()) {
+			entity.assign<sitara::ecs::StaticBody>(staticActor)->mShape = shape;
+		}
+
+		entityx::ComponentHandle<sitara::ecs::Transform> transform = entity.component<sitara::ecs::Transform>();
+		if (transform.valid()) {
+			physx::PxTransform pose = actor->getGlobalPose();
+			transform->mPosition = sitara::ecs::physics::from(pose.p);
+			transform->mOrientation = sitara::ecs::physics::from(pose.q);
+		}
+
+		if (onEntityFn) {
+			onEntityFn(entity, uint64_t(id) - 1);
+		}
+	}
+
+	collection->release();
+	return true;
+}
+
+void PhysicsSystem::enableIncrementalOverlaps(const bool enable) {
+	mIncrementalOverlaps = enable;
+	mOverlapSceneChanged = true;
+	mChangedBounds.clear();
+	mChangedIds.clear();
+	mAddedOverlapBodies.clear();
+}
+
+void PhysicsSystem::setMaximumLinearVelocity(entityx::Entity& entity, float maximumVelocity) {
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
+
+	if (body.valid()) {
+		body->getBody()->setMaxLinearVelocity(maximumVelocity);
 	}
 	/*
 	else {
@@ -308,6 +2008,29 @@ void PhysicsSystem::setMaximumLinearVelocity(entityx::Entity& entity, float maxi
 	*/
 }
 
+void PhysicsSystem::setKinematic(entityx::Entity& entity, bool kinematic) {
+	entityx::ComponentHandle<sitara::ecs::DynamicBody> body = entity.component<sitara::ecs::DynamicBody>();
+	if (!body.valid() || !body->mBody || body->isKinematic() == kinematic) {
+		return;
+	}
+
+	// the flag can't change while the body's scene is stepping
+	fetchPendingResults();
+	body->setKinematic(kinematic);
+	if (kinematic) {
+		mKinematicBodies.push_back(body);
+	}
+	else {
+		removeKinematicBody(entity.id());
+	}
+}
+
+void PhysicsSystem::removeKinematicBody(entityx::Entity::Id id) {
+	mKinematicBodies.erase(std::remove_if(mKinematicBodies.begin(), mKinematicBodies.end(), [id](entityx::ComponentHandle<sitara::ecs::DynamicBody>& body) {
+		return body.entity().id() == id;
+	}), mKinematicBodies.end());
+}
+
 void PhysicsSystem::addPreUpdateFn(std::function<void(entityx::ComponentHandle<sitara::ecs::DynamicBody>)> callback) {
 	mPreUpdateFns.push_back(callback);
 }
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <iostream>
+#include "utilities/JobPool.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace sitara::ecs;
+
+namespace {
+	// index of the queue owned by the current thread, or -1 for threads outside the pool
+	thread_local int sWorkerIndex = -1;
+	thread_local const JobPool* sWorkerPool = nullptr;
+
+	uint32_t sInstanceWorkers = 0;
+	bool sInstancePinned = false;
+	bool sInstanceCreated = false;
+}
+
+JobPool& JobPool::getInstance() {
+	static JobPool instance(sInstanceWorkers, sInstancePinned);
+	sInstanceCreated = true;
+	return instance;
+}
+
+void JobPool::configureInstance(uint32_t numWorkers, bool pinThreads) {
+	if (sInstanceCreated) {
+		std::cout << "sitara::ecs::JobPool -- the shared pool is already running; configure it before any system uses it." << std::endl;
+		return;
+	}
+	sInstanceWorkers = numWorkers;
+	sInstancePinned = pinThreads;
+}
+
+JobPool::JobPool(uint32_t numWorkers, bool pinThreads) : mNextQueue(0), mQueuedJobs(0), mStop(false) {
+	if (numWorkers == 0) {
+		// leave one core for the thread that drives the app
+		uint32_t cores = std::thread::hardware_concurrency();
+		numWorkers = (cores > 1) ? cores - 1 : 1;
+	}
+
+	for (uint32_t i = 0; i < numWorkers; i++) {
+		mQueues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (uint32_t i = 0; i < numWorkers; i++) {
+		mWorkers.emplace_back(&JobPool::workerLoop, this, i);
+		if (pinThreads) {
+			pinWorker(i);
+		}
+	}
+}
+
+JobPool::~JobPool() {
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mStop = true;
+	}
+	mWake.notify_all();
+	for (auto& worker : mWorkers) {
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+}
+
+uint32_t JobPool::getWorkerCount() const {
+	return static_cast<uint32_t>(mWorkers.size());
+}
+
+void JobPool::submit(std::function<void()> job) {
+	uint32_t queueIndex;
+	if (sWorkerPool == this) {
+		// jobs spawned from a worker stay local; idle workers will steal them
+		queueIndex = static_cast<uint32_t>(sWorkerIndex);
+	}
+	else {
+		queueIndex = mNextQueue.fetch_add(1) % mQueues.size();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mQueues[queueIndex]->mMutex);
+		mQueues[queueIndex]->mJobs.push_back(std::move(job));
+	}
+	mQueuedJobs++;
+
+	{
+		// taking the lock orders the increment above against a worker that is about to sleep
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+	}
+	mWake.notify_one();
+}
+
+void JobPool::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& fn) {
+	if (count == 0) {
+		return;
+	}
+	if (grainSize == 0) {
+		grainSize = 1;
+	}
+
+	size_t chunkCount = (count + grainSize - 1) / grainSize;
+	if (chunkCount == 1) {
+		fn(0, count);
+		return;
+	}
+
+	auto remaining = std::make_shared<std::atomic<size_t>>(chunkCount - 1);
+
+	for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+		size_t begin = chunk * grainSize;
+		size_t end = std::min(begin + grainSize, count);
+		submit([&fn, remaining, begin, end]() {
+			fn(begin, end);
+			(*remaining)--;
+		});
+	}
+
+	// the calling thread takes the first chunk, then helps out until everything has finished
+	fn(0, std::min(grainSize, count));
+
+	uint32_t preferredQueue = (sWorkerPool == this) ? static_cast<uint32_t>(sWorkerIndex) : 0;
+	while (remaining->load() > 0) {
+		if (!tryRunJob(preferredQueue)) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobPool::pinWorker(uint32_t index) {
+	// worker i goes on core i + 1 so core 0 stays with the main thread
+	uint32_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+	uint32_t core = (index + 1) % cores;
+#if defined(_WIN32)
+	SetThreadAffinityMask(static_cast<HANDLE>(mWorkers[index].native_handle()), DWORD_PTR(1) << core);
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	pthread_setaffinity_np(mWorkers[index].native_handle(), sizeof(set), &set);
+#else
+	// no affinity API here (macOS); workers float
+	(void)core;
+#endif
+}
+
+void JobPool::workerLoop(uint32_t index) {
+	sWorkerIndex = static_cast<int>(index);
+	sWorkerPool = this;
+
+	while (true) {
+		if (tryRunJob(index)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		mWake.wait(lock, [this]() { return mStop || mQueuedJobs.load() > 0; });
+		if (mStop && mQueuedJobs.load() <= 0) {
+			return;
+		}
+	}
+}
+
+bool JobPool::tryRunJob(uint32_t preferredQueue) {
+	std::function<void()> job;
+	if (popJob(preferredQueue, job) || stealJob(preferredQueue, job)) {
+		mQueuedJobs--;
+		job();
+		return true;
+	}
+	return false;
+}
+
+bool JobPool::popJob(uint32_t queueIndex, std::function<void()>& job) {
+	WorkerQueue& queue = *mQueues[queueIndex];
+	std::lock_guard<std::mutex> lock(queue.mMutex);
+	if (queue.mJobs.empty()) {
+		return false;
+	}
+	job = std::move(queue.mJobs.back());
+	queue.mJobs.pop_back();
+	return true;
+}
+
+bool JobPool::stealJob(uint32_t thiefIndex, std::function<void()>& job) {
+	size_t queueCount = mQueues.size();
+	for (size_t offset = 1; offset < queueCount; offset++) {
+		WorkerQueue& queue = *mQueues[(thiefIndex + offset) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mMutex);
+		if (!queue.mJobs.empty()) {
+			job = std::move(queue.mJobs.front());
+			queue.mJobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}